@@ -0,0 +1,87 @@
+// Benchmark for the decoding presets.
+// Transcribes a clip with each preset and reports the real-time factor
+// (decode time / audio length, best of three runs) and the word error rate
+// against a reference transcript. Without a clip, whisper.cpp's JFK sample
+// and its known transcript are used, the same as the in-app benchmark.
+//
+// Usage: decoding_bench model.bin [clip.wav "reference transcript"] [threads]
+
+#include "DecodingPresets.h"
+#include "WavReader.h"
+#include <whisper.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s model.bin [clip.wav \"reference transcript\"] [threads]\n", argv[0]);
+        return 1;
+    }
+    const std::string clipPath = argc > 3 ? argv[2] : WHISPERGUI_REFERENCE_CLIP;
+    const std::string reference = argc > 3 ? argv[3] : DecodingPresets::kReferenceText;
+    const int threads = argc > 4 ? std::atoi(argv[4]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency() / 2));
+
+    std::vector<float> pcm;
+    int sampleRate = 0;
+    int channels = 0;
+    if (!WavReader::readFile(clipPath, pcm, sampleRate, channels, kSampleRate) || sampleRate != kSampleRate) {
+        std::fprintf(stderr, "Could not read %s as 16 kHz audio\n", clipPath.c_str());
+        return 1;
+    }
+
+    whisper_context* ctx = whisper_init_from_file_with_params(argv[1], whisper_context_default_params());
+    if (!ctx) {
+        std::fprintf(stderr, "Could not load %s\n", argv[1]);
+        return 1;
+    }
+
+    const double clipSeconds = static_cast<double>(pcm.size()) / kSampleRate;
+    std::printf("%s, %.1f s clip, %d threads\n", clipPath.c_str(), clipSeconds, threads);
+    std::printf("  %-10s %8s %8s %8s\n", "preset", "ms", "RTF", "WER");
+    for (int i = 0; i < DecodingPresets::kCount; ++i) {
+        const auto preset = static_cast<DecodingPresets::Preset>(i);
+        whisper_full_params wparams = DecodingPresets::params(preset, static_cast<float>(clipSeconds));
+        wparams.print_progress = false;
+        wparams.print_realtime = false;
+        wparams.print_timestamps = false;
+        wparams.language = "en";
+        wparams.no_context = true;
+        wparams.token_timestamps = true; // As in the app
+        wparams.n_threads = threads;
+
+        if (i == 0) whisper_full(ctx, wparams, pcm.data(), static_cast<int>(pcm.size())); // Warm-up
+        double bestMs = 0.0;
+        std::string text;
+        for (int run = 0; run < 3; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            if (whisper_full(ctx, wparams, pcm.data(), static_cast<int>(pcm.size())) != 0) {
+                std::fprintf(stderr, "whisper_full failed\n");
+                whisper_free(ctx);
+                return 1;
+            }
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || ms < bestMs) bestMs = ms;
+            if (run == 0) {
+                for (int s = 0; s < whisper_full_n_segments(ctx); ++s) {
+                    text += whisper_full_get_segment_text(ctx, s);
+                }
+            }
+        }
+        std::printf("  %-10s %8.0f %8.3f %7.1f%%\n", DecodingPresets::name(preset), bestMs,
+                    bestMs / (1000.0 * clipSeconds), 100.0 * DecodingPresets::wordErrorRate(reference, text));
+    }
+
+    whisper_free(ctx);
+    return 0;
+}
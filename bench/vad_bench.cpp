@@ -0,0 +1,79 @@
+// Benchmark for the VAD pre-pass.
+// Runs VoiceActivity::detect/compact over a recording and reports how much
+// audio is kept and how many 30 s whisper encoder windows that saves per
+// hour of input. Without a file, a synthetic dictation-style recording
+// (voiced bursts separated by noisy pauses) is used.
+//
+// Usage: vad_bench [file.wav]
+
+#include "VoiceActivity.h"
+#include "WavReader.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+
+// Harmonic bursts 2-12 s long, pauses 0.5-8 s of low-level hiss; returns the speech share
+double makeSynthetic(std::vector<float>& pcm, double minutes) {
+    const size_t total = static_cast<size_t>(minutes * 60.0 * kSampleRate);
+    pcm.assign(total, 0.0f);
+    srand(7);
+    size_t i = 0;
+    size_t speech = 0;
+    while (i < total) {
+        const size_t burst = static_cast<size_t>((2.0 + rand() % 100 / 10.0) * kSampleRate);
+        const double f0 = 100.0 + rand() % 120;
+        for (size_t k = 0; k < burst && i < total; ++k, ++i, ++speech) {
+            const double t = static_cast<double>(k) / kSampleRate;
+            const double envelope = 0.5 + 0.5 * std::sin(2.0 * 3.14159265 * 4.0 * t); // ~syllable rate
+            double v = 0.0;
+            for (int h = 1; h <= 12; ++h) v += std::sin(2.0 * 3.14159265 * f0 * h * t) / h;
+            pcm[i] = static_cast<float>(0.08 * envelope * v);
+        }
+        const size_t pause = static_cast<size_t>((0.5 + rand() % 75 / 10.0) * kSampleRate);
+        for (size_t k = 0; k < pause && i < total; ++k, ++i) {
+            pcm[i] = 0.002f * (static_cast<float>(rand()) / RAND_MAX - 0.5f);
+        }
+    }
+    return static_cast<double>(speech) / static_cast<double>(total);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<float> pcm;
+    if (argc > 1) {
+        int sampleRate = 0;
+        int channels = 0;
+        if (!WavReader::readFile(argv[1], pcm, sampleRate, channels, kSampleRate) || sampleRate != kSampleRate) {
+            std::fprintf(stderr, "Could not read %s as 16 kHz audio\n", argv[1]);
+            return 1;
+        }
+        std::printf("%s\n", argv[1]);
+    } else {
+        const double speechShare = makeSynthetic(pcm, 60.0);
+        std::printf("synthetic 60 min recording, %.1f%% voiced\n", 100.0 * speechShare);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<VoiceActivity::Region> regions = VoiceActivity::detect(pcm.data(), pcm.size(), kSampleRate);
+    const VoiceActivity::CompactAudio speech = VoiceActivity::compact(pcm.data(), pcm.size(), kSampleRate, regions);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const double hours = static_cast<double>(pcm.size()) / kSampleRate / 3600.0;
+    const int64_t before = VoiceActivity::encoderWindows(pcm.size(), kSampleRate);
+    const int64_t after = VoiceActivity::encoderWindows(speech.samples.size(), kSampleRate);
+
+    std::printf("  audio:            %10.1f s\n", static_cast<double>(pcm.size()) / kSampleRate);
+    std::printf("  kept:             %10.1f s (%.1f%%, %zu regions)\n", static_cast<double>(speech.samples.size()) / kSampleRate,
+                100.0 * static_cast<double>(speech.samples.size()) / static_cast<double>(pcm.size()), regions.size());
+    std::printf("  encoder windows:  %10lld -> %lld\n", static_cast<long long>(before), static_cast<long long>(after));
+    std::printf("  saved per hour:   %10.1f windows\n", static_cast<double>(before - after) / hours);
+    std::printf("  VAD time:         %10.1f ms (%.0fx real time)\n", ms, pcm.size() / (kSampleRate * ms / 1000.0));
+    return 0;
+}
@@ -0,0 +1,238 @@
+// Benchmark for the WAV read path.
+// Generates synthetic 16 kHz recordings, then times the original ifstream
+// reader against the memory-mapped WavReader with each conversion kernel.
+//
+// Usage: wav_reader_bench [minutes...]   (default: 1 60 240)
+
+#include "WavReader.h"
+#include "SampleConvert.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+
+void writeU32(std::ofstream& out, uint32_t v) { out.write(reinterpret_cast<const char*>(&v), 4); }
+void writeU16(std::ofstream& out, uint16_t v) { out.write(reinterpret_cast<const char*>(&v), 2); }
+
+bool writeSyntheticWav(const fs::path& path, double minutes, int channels) {
+    const uint64_t frames = static_cast<uint64_t>(minutes * 60.0 * kSampleRate);
+    const uint64_t dataBytes = frames * channels * sizeof(int16_t);
+    if (dataBytes > 0xFFFFFFF0ull) return false;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    out.write("RIFF", 4);
+    writeU32(out, static_cast<uint32_t>(36 + dataBytes));
+    out.write("WAVE", 4);
+    out.write("fmt ", 4);
+    writeU32(out, 16);
+    writeU16(out, 1);
+    writeU16(out, static_cast<uint16_t>(channels));
+    writeU32(out, kSampleRate);
+    writeU32(out, kSampleRate * channels * 2);
+    writeU16(out, static_cast<uint16_t>(channels * 2));
+    writeU16(out, 16);
+    out.write("data", 4);
+    writeU32(out, static_cast<uint32_t>(dataBytes));
+
+    // Two detuned tones plus a little noise so the data isn't trivially compressible
+    std::vector<int16_t> block(65536 * channels);
+    uint32_t seed = 12345;
+    uint64_t written = 0;
+    while (written < frames) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(65536, frames - written));
+        for (size_t i = 0; i < n; ++i) {
+            const double t = static_cast<double>(written + i) / kSampleRate;
+            for (int c = 0; c < channels; ++c) {
+                seed = seed * 1664525u + 1013904223u;
+                const double noise = (static_cast<int>(seed >> 16) - 32768) / 32768.0 * 0.05;
+                const double v = 0.4 * std::sin(2.0 * 3.14159265 * (220.0 + c * 3.0) * t) + noise;
+                block[i * channels + c] = static_cast<int16_t>(v * 32767.0);
+            }
+        }
+        out.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(n * channels * sizeof(int16_t)));
+        written += n;
+    }
+    return static_cast<bool>(out);
+}
+
+// The reader WhisperEngine used before the memory-mapped path
+bool readWavLegacy(const std::string& wavPath, std::vector<float>& pcmf32) {
+    std::ifstream file(wavPath, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char riffHeader[12];
+    file.read(riffHeader, sizeof(riffHeader));
+    if (std::strncmp(riffHeader, "RIFF", 4) != 0) return false;
+
+    int channels = 0;
+    uint16_t bitsPerSample = 0;
+    uint32_t dataSize = 0;
+    bool foundFmt = false;
+    bool foundData = false;
+    std::streampos dataOffset = 0;
+
+    while (file && (!foundFmt || !foundData)) {
+        char chunkId[4];
+        uint32_t chunkSize = 0;
+        file.read(chunkId, 4);
+        file.read(reinterpret_cast<char*>(&chunkSize), 4);
+        if (!file) break;
+
+        if (std::strncmp(chunkId, "fmt ", 4) == 0) {
+            uint16_t audioFormat = 0, channelsRaw = 0;
+            uint32_t sampleRateRaw = 0;
+            file.read(reinterpret_cast<char*>(&audioFormat), 2);
+            file.read(reinterpret_cast<char*>(&channelsRaw), 2);
+            file.read(reinterpret_cast<char*>(&sampleRateRaw), 4);
+            channels = channelsRaw;
+            file.seekg(6, std::ios::cur);
+            file.read(reinterpret_cast<char*>(&bitsPerSample), 2);
+            if (chunkSize > 16) file.seekg(chunkSize - 16, std::ios::cur);
+            foundFmt = true;
+        } else if (std::strncmp(chunkId, "data", 4) == 0) {
+            dataSize = chunkSize;
+            dataOffset = file.tellg();
+            file.seekg(chunkSize, std::ios::cur);
+            foundData = true;
+        } else {
+            file.seekg(chunkSize, std::ios::cur);
+        }
+        if (chunkSize % 2 == 1) file.seekg(1, std::ios::cur);
+    }
+    if (!foundFmt || !foundData || bitsPerSample != 16) return false;
+
+    const uint32_t bytesPerFrame = static_cast<uint32_t>(channels * 2);
+    const size_t numFrames = dataSize / bytesPerFrame;
+    pcmf32.resize(numFrames);
+
+    file.clear();
+    file.seekg(dataOffset, std::ios::beg);
+
+    std::vector<int16_t> buffer(4096 * channels);
+    size_t total = 0;
+    while (total < numFrames && file) {
+        const size_t framesToRead = std::min(numFrames - total, buffer.size() / channels);
+        file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(framesToRead * bytesPerFrame));
+        const size_t framesRead = static_cast<size_t>(file.gcount()) / bytesPerFrame;
+        for (size_t i = 0; i < framesRead; ++i) {
+            if (channels == 1) {
+                pcmf32[total + i] = static_cast<float>(buffer[i]) / 32768.0f;
+            } else {
+                const float left = static_cast<float>(buffer[i * 2]) / 32768.0f;
+                const float right = static_cast<float>(buffer[i * 2 + 1]) / 32768.0f;
+                pcmf32[total + i] = (left + right) / 2.0f;
+            }
+        }
+        total += framesRead;
+        if (framesRead == 0) break;
+    }
+    pcmf32.resize(total);
+    return !pcmf32.empty();
+}
+
+template <typename Fn>
+double timeBest(int runs, Fn&& fn) {
+    double best = 1e30;
+    for (int r = 0; r < runs; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+float maxAbsDiff(const std::vector<float>& a, const std::vector<float>& b) {
+    if (a.size() != b.size()) return INFINITY;
+    float diff = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+void benchKernels(size_t frames, int channels) {
+    std::vector<int16_t> input(frames * channels);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<int16_t>((i * 2654435761u) >> 16);
+    }
+    std::vector<float> reference(frames);
+    std::vector<float> output(frames);
+
+    const SampleConvert::Kernel kernels[] = {
+        SampleConvert::Kernel::Scalar, SampleConvert::Kernel::SSE2, SampleConvert::Kernel::AVX2
+    };
+    for (SampleConvert::Kernel kernel : kernels) {
+        auto convert = [&](std::vector<float>& out) {
+            if (channels == 1) SampleConvert::s16ToFloat(input.data(), out.data(), frames, kernel);
+            else SampleConvert::s16StereoToMonoFloat(input.data(), out.data(), frames, kernel);
+        };
+        if (kernel == SampleConvert::Kernel::Scalar) convert(reference);
+        const double ms = timeBest(5, [&]() { convert(output); });
+        std::printf("  kernel %-6s %d ch: %8.2f ms  (%6.0f Mframes/s, max diff vs scalar %g)\n",
+                    SampleConvert::kernelName(kernel), channels, ms, frames / ms / 1000.0,
+                    maxAbsDiff(reference, output));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<double> minutes;
+    for (int i = 1; i < argc; ++i) minutes.push_back(std::atof(argv[i]));
+    if (minutes.empty()) minutes = {1.0, 60.0, 240.0};
+
+    std::printf("Best kernel on this CPU: %s\n\n", SampleConvert::kernelName(SampleConvert::bestKernel()));
+
+    std::printf("Conversion kernels (in memory, 1 hour of audio):\n");
+    benchKernels(static_cast<size_t>(kSampleRate) * 3600, 1);
+    benchKernels(static_cast<size_t>(kSampleRate) * 3600, 2);
+    std::printf("\n");
+
+    const fs::path dir = fs::temp_directory_path() / "whispergui_wav_bench";
+    fs::create_directories(dir);
+
+    for (double m : minutes) {
+        for (int channels = 1; channels <= 2; ++channels) {
+            const fs::path path = dir / ("bench_" + std::to_string(static_cast<int>(m)) + "min_" + std::to_string(channels) + "ch.wav");
+            if (!writeSyntheticWav(path, m, channels)) {
+                std::printf("%6.0f min %d ch: skipped (file too large for a RIFF header)\n", m, channels);
+                continue;
+            }
+
+            std::vector<float> legacy;
+            std::vector<float> mapped;
+            const int runs = m > 60.0 ? 2 : 3;
+            const double legacyMs = timeBest(runs, [&]() { readWavLegacy(path.string(), legacy); });
+            const double mappedMs = timeBest(runs, [&]() {
+                int sampleRate = 0;
+                int ch = 0;
+                WavReader::readFile(path.string(), mapped, sampleRate, ch);
+            });
+
+            std::printf("%6.0f min %d ch: ifstream %9.1f ms | mmap+%s %9.1f ms | speedup %5.2fx | max diff %g\n",
+                        m, channels, legacyMs, SampleConvert::kernelName(SampleConvert::bestKernel()), mappedMs,
+                        legacyMs / mappedMs, maxAbsDiff(legacy, mapped));
+
+            std::error_code ec;
+            fs::remove(path, ec);
+        }
+    }
+
+    std::error_code ec;
+    fs::remove(dir, ec);
+    return 0;
+}
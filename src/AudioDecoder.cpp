@@ -0,0 +1,230 @@
+#include "AudioDecoder.h"
+#include "Resampler.h"
+#include "Logger.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#define DR_MP3_IMPLEMENTATION
+#include "dr_mp3.h"
+#define DR_FLAC_IMPLEMENTATION
+#include "dr_flac.h"
+#include "stb_vorbis.c"
+// stb_vorbis leaks single-letter macros into the including file
+#undef L
+#undef C
+#undef R
+
+namespace {
+    constexpr size_t kChunkFrames = 4096;
+    constexpr uint64_t kMaxFrames = static_cast<uint64_t>(48000) * 60 * 60 * 8; // 8 hours at 48 kHz
+
+    void downmixToMono(const float* in, float* out, size_t frames, int channels) {
+        if (channels == 1) {
+            std::memcpy(out, in, frames * sizeof(float));
+            return;
+        }
+        if (channels == 2) {
+            for (size_t i = 0; i < frames; ++i) {
+                out[i] = (in[2 * i] + in[2 * i + 1]) * 0.5f;
+            }
+            return;
+        }
+        const float scale = 1.0f / static_cast<float>(channels);
+        for (size_t i = 0; i < frames; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                sum += in[i * channels + c];
+            }
+            out[i] = sum * scale;
+        }
+    }
+}
+
+struct AudioDecoder::Impl {
+    drmp3 mp3;
+    bool mp3Open = false;
+    drflac* flac = nullptr;
+    stb_vorbis* vorbis = nullptr;
+};
+
+AudioDecoder::AudioDecoder() : impl_(std::make_unique<Impl>()) {
+}
+
+AudioDecoder::~AudioDecoder() {
+    close();
+}
+
+AudioDecoder::Format AudioDecoder::detectFormat(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return Format::Unknown;
+
+    unsigned char header[36] = {};
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    const std::streamsize n = file.gcount();
+    if (n < 4) return Format::Unknown;
+
+    if (std::memcmp(header, "fLaC", 4) == 0) return Format::Flac;
+
+    if (std::memcmp(header, "OggS", 4) == 0) {
+        // First page carries the codec identification header; Opus ("OpusHead") isn't handled here
+        if (n >= 35 && std::memcmp(header + 28, "\x01vorbis", 7) == 0) return Format::Vorbis;
+        return Format::Unknown;
+    }
+
+    if (std::memcmp(header, "ID3", 3) == 0) return Format::Mp3;
+    // MPEG audio frame sync; layer bits of 00 are reserved, which also rules out AAC ADTS
+    if (header[0] == 0xFF && (header[1] & 0xE0) == 0xE0 && (header[1] & 0x06) != 0) return Format::Mp3;
+
+    return Format::Unknown;
+}
+
+const char* AudioDecoder::formatName(Format format) {
+    switch (format) {
+        case Format::Mp3: return "MP3";
+        case Format::Flac: return "FLAC";
+        case Format::Vorbis: return "Ogg Vorbis";
+        default: return "unknown";
+    }
+}
+
+bool AudioDecoder::open(const std::string& path) {
+    close();
+
+    const Format format = detectFormat(path);
+    switch (format) {
+        case Format::Mp3:
+            if (!drmp3_init_file(&impl_->mp3, path.c_str(), nullptr)) return false;
+            impl_->mp3Open = true;
+            channels_ = static_cast<int>(impl_->mp3.channels);
+            sampleRate_ = static_cast<int>(impl_->mp3.sampleRate);
+            frameCount_ = 0; // Would need a full scan of the file
+            break;
+        case Format::Flac:
+            impl_->flac = drflac_open_file(path.c_str(), nullptr);
+            if (!impl_->flac) return false;
+            channels_ = static_cast<int>(impl_->flac->channels);
+            sampleRate_ = static_cast<int>(impl_->flac->sampleRate);
+            frameCount_ = impl_->flac->totalPCMFrameCount;
+            break;
+        case Format::Vorbis: {
+            int error = 0;
+            impl_->vorbis = stb_vorbis_open_filename(path.c_str(), &error, nullptr);
+            if (!impl_->vorbis) return false;
+            const stb_vorbis_info info = stb_vorbis_get_info(impl_->vorbis);
+            channels_ = info.channels;
+            sampleRate_ = static_cast<int>(info.sample_rate);
+            frameCount_ = stb_vorbis_stream_length_in_samples(impl_->vorbis);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    format_ = format;
+    if (channels_ <= 0 || sampleRate_ <= 0) {
+        close();
+        return false;
+    }
+    interleaved_.resize(kChunkFrames * channels_);
+    return true;
+}
+
+void AudioDecoder::close() {
+    if (impl_->mp3Open) {
+        drmp3_uninit(&impl_->mp3);
+        impl_->mp3Open = false;
+    }
+    if (impl_->flac) {
+        drflac_close(impl_->flac);
+        impl_->flac = nullptr;
+    }
+    if (impl_->vorbis) {
+        stb_vorbis_close(impl_->vorbis);
+        impl_->vorbis = nullptr;
+    }
+    format_ = Format::Unknown;
+    sampleRate_ = 0;
+    channels_ = 0;
+    frameCount_ = 0;
+}
+
+size_t AudioDecoder::readMono(float* out, size_t maxFrames) {
+    size_t total = 0;
+    while (total < maxFrames) {
+        const size_t want = std::min(kChunkFrames, maxFrames - total);
+        size_t got = 0;
+
+        switch (format_) {
+            case Format::Mp3:
+                got = static_cast<size_t>(drmp3_read_pcm_frames_f32(&impl_->mp3, want, interleaved_.data()));
+                break;
+            case Format::Flac:
+                got = static_cast<size_t>(drflac_read_pcm_frames_f32(impl_->flac, want, interleaved_.data()));
+                break;
+            case Format::Vorbis:
+                got = static_cast<size_t>(stb_vorbis_get_samples_float_interleaved(
+                    impl_->vorbis, channels_, interleaved_.data(), static_cast<int>(want * channels_)));
+                break;
+            default:
+                return total;
+        }
+
+        if (got == 0) break;
+        downmixToMono(interleaved_.data(), out + total, got, channels_);
+        total += got;
+    }
+    return total;
+}
+
+bool AudioDecoder::decodeFile(const std::string& path, std::vector<float>& pcmf32, int& sampleRate,
+                              int targetSampleRate) {
+    AudioDecoder decoder;
+    if (!decoder.open(path)) return false;
+
+    sampleRate = decoder.getSampleRate();
+    pcmf32.clear();
+
+    // An unsupported ratio is decoded at the native rate so the caller can fall back
+    Resampler resampler;
+    const bool resample = targetSampleRate > 0 && targetSampleRate != sampleRate &&
+                          resampler.configure(sampleRate, targetSampleRate);
+
+    if (decoder.getFrameCount() > 0 && decoder.getFrameCount() <= kMaxFrames) {
+        const uint64_t expected = resample ? resampler.outputLength(decoder.getFrameCount()) : decoder.getFrameCount();
+        pcmf32.reserve(static_cast<size_t>(expected));
+    }
+
+    // Decode a chunk at a time: straight into the output buffer, or through the resampler
+    const size_t chunk = kChunkFrames * 16;
+    std::vector<float> scratch(resample ? chunk : 0);
+    uint64_t decodedFrames = 0;
+    while (true) {
+        if (decodedFrames >= kMaxFrames) {
+            LOG_WARNING("Decoded audio exceeds the length limit, truncating: " + path);
+            break;
+        }
+        size_t got = 0;
+        if (resample) {
+            got = decoder.readMono(scratch.data(), chunk);
+            resampler.process(scratch.data(), got, pcmf32);
+        } else {
+            const size_t offset = pcmf32.size();
+            pcmf32.resize(offset + chunk);
+            got = decoder.readMono(pcmf32.data() + offset, chunk);
+            pcmf32.resize(offset + got);
+        }
+        decodedFrames += got;
+        if (got < chunk) break;
+    }
+
+    if (resample) {
+        resampler.flush(pcmf32);
+        sampleRate = targetSampleRate;
+    }
+
+    LOG_INFO(std::string("Decoded ") + formatName(decoder.getFormat()) + " file: " +
+             std::to_string(decodedFrames) + " frames at " + std::to_string(decoder.getSampleRate()) + " Hz" +
+             (resample ? ", resampled to " + std::to_string(targetSampleRate) + " Hz" : std::string()));
+    return !pcmf32.empty();
+}
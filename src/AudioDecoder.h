@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// In-process decoder for compressed audio files (MP3, FLAC, Ogg Vorbis).
+// Decodes chunk by chunk to mono float so files never go through a temp WAV.
+// Formats without a built-in decoder (Opus, AAC, WMA, ...) are left to the
+// ffmpeg fallback in WhisperEngine::transcribeFile.
+class AudioDecoder {
+public:
+    enum class Format {
+        Unknown,
+        Mp3,
+        Flac,
+        Vorbis
+    };
+
+    AudioDecoder();
+    ~AudioDecoder();
+
+    AudioDecoder(const AudioDecoder&) = delete;
+    AudioDecoder& operator=(const AudioDecoder&) = delete;
+
+    // Identify the container from the first bytes of the file
+    static Format detectFormat(const std::string& path);
+    static const char* formatName(Format format);
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return format_ != Format::Unknown; }
+    Format getFormat() const { return format_; }
+    int getSampleRate() const { return sampleRate_; }
+    int getChannels() const { return channels_; }
+    // Total frames if the container stores it, otherwise 0
+    uint64_t getFrameCount() const { return frameCount_; }
+
+    // Decode up to maxFrames frames, downmixed to mono. Returns 0 at the end of the stream.
+    size_t readMono(float* out, size_t maxFrames);
+
+    // Decode the whole file as mono float. With a targetSampleRate each decoded
+    // chunk is resampled as it arrives and sampleRate reports the target.
+    static bool decodeFile(const std::string& path, std::vector<float>& pcmf32, int& sampleRate,
+                           int targetSampleRate = 0);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    Format format_ = Format::Unknown;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    uint64_t frameCount_ = 0;
+    std::vector<float> interleaved_;
+};
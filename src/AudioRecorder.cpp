@@ -7,7 +7,7 @@ AudioRecorder::AudioRecorder() {
     if (SDL_Init(SDL_INIT_AUDIO) < 0) {
         std::cerr << "SDL Audio Init Failed: " << SDL_GetError() << std::endl;
     }
-    lastSoundTime_ = std::chrono::steady_clock::now();
+    markSound();
 }
 
 AudioRecorder::~AudioRecorder() {
@@ -27,34 +27,23 @@ std::vector<AudioRecorder::DeviceInfo> AudioRecorder::getInputDevices() {
 bool AudioRecorder::startRecording(int deviceIndex, const std::string& outputPath, bool useMp3) {
     if (isRecording_) return false;
 
-    outputPath_ = outputPath;
     isMp3_ = useMp3;
     currentAmplitude_ = 0.0f;
     recentPeakAmplitude_ = 0.0f;
-    lastSoundTime_ = std::chrono::steady_clock::now();
+    markSound();
+    segmentSamples_.clear();
+    overruns_ = 0;
+    droppedBytes_ = 0;
 
-    outputFile_.open(outputPath, std::ios::binary);
-    if (!outputFile_.is_open()) {
-        std::cerr << "Failed to open output file: " << outputPath << std::endl;
+    // An empty output path records to memory only (live segments without archival)
+    if (!sink_.open(outputPath)) {
         return false;
     }
 
-    tempWavFile_.open(tempWavPath_, std::ios::binary);
-    if (!tempWavFile_.is_open()) {
-         std::cerr << "Failed to open temp wav file" << std::endl;
-         outputFile_.close();
-         return false;
-    }
-    writeWavHeader(tempWavFile_, sampleRate_, 16, channels_, 0);
-
     if (isMp3_) {
         // MP3 disabled
         std::cerr << "MP3 support disabled in this build." << std::endl;
         isMp3_ = false; // Fallback to WAV
-        writeWavHeader(outputFile_, sampleRate_, 16, channels_, 0);
-    } else {
-        // Write placeholder WAV header for output file
-        writeWavHeader(outputFile_, sampleRate_, 16, channels_, 0);
     }
 
     SDL_AudioSpec want, have;
@@ -74,8 +63,7 @@ bool AudioRecorder::startRecording(int deviceIndex, const std::string& outputPat
     deviceId_ = SDL_OpenAudioDevice(deviceName, 1, &want, &have, SDL_AUDIO_ALLOW_ANY_CHANGE);
     if (deviceId_ == 0) {
         std::cerr << "Failed to open audio device: " << SDL_GetError() << std::endl;
-        outputFile_.close();
-        tempWavFile_.close();
+        sink_.close();
         return false;
     }
 
@@ -85,13 +73,21 @@ bool AudioRecorder::startRecording(int deviceIndex, const std::string& outputPat
     if (!audioStream_) {
         std::cerr << "Failed to create audio stream: " << SDL_GetError() << std::endl;
         SDL_CloseAudioDevice(deviceId_);
-        outputFile_.close();
-        tempWavFile_.close();
+        sink_.close();
         return false;
     }
 
-    totalBytesRecorded_ = 0;
+    // The device opens paused, so neither side of the ring is running yet
+    deviceFrameBytes_ = static_cast<int>(SDL_AUDIO_BITSIZE(have.format) / 8) * have.channels;
+    deviceRate_ = have.freq;
+    const size_t callbackBytes = static_cast<size_t>(have.samples) * deviceFrameBytes_;
+    ring_.reset(std::max(static_cast<size_t>(kRingSeconds) * have.freq * deviceFrameBytes_, 4 * callbackBytes));
+    drainBuffer_.assign(callbackBytes, 0);
+    convertBuffer_.assign(4096, 0);
+
     isRecording_ = true;
+    writerRunning_ = true;
+    writerThread_ = std::thread(&AudioRecorder::writerLoop, this);
     SDL_PauseAudioDevice(deviceId_, 0);
     return true;
 }
@@ -99,77 +95,106 @@ bool AudioRecorder::startRecording(int deviceIndex, const std::string& outputPat
 void AudioRecorder::stopRecording() {
     if (!isRecording_) return;
 
-    if (deviceId_ != 0) {
-        SDL_LockAudioDevice(deviceId_);
-    }
     isRecording_ = false;
-    if (deviceId_ != 0) {
-        SDL_UnlockAudioDevice(deviceId_);
-    }
     SDL_CloseAudioDevice(deviceId_);
     deviceId_ = 0;
 
+    // The callback has stopped; write out whatever is still in the ring
+    writerRunning_ = false;
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    drainLocked();
+    if (overruns_ > 0) {
+        std::cerr << "Audio capture overruns: " << overruns_ << " (" << toOutputSamples(droppedBytes_)
+                  << " samples dropped)" << std::endl;
+    }
+
     if (audioStream_) {
+        // The resampler's tail
+        SDL_AudioStreamFlush(audioStream_);
+        convertLocked();
         SDL_FreeAudioStream(audioStream_);
         audioStream_ = nullptr;
     }
 
-    // Finalize temp wav
-    finalizeWavFile(); // Refactored below to handle tempWavFile_
-    tempWavFile_.close();
-
-    if (false /*isMp3_ && lame_*/) {
-        // ...
-    } else {
-        // Finalize output wav
-        if (outputFile_.is_open()) {
-            outputFile_.seekp(0, std::ios::beg);
-            writeWavHeader(outputFile_, sampleRate_, 16, channels_, totalBytesRecorded_);
-        }
-    }
-
-    outputFile_.close();
+    // Pending block and final header
+    sink_.close();
     currentAmplitude_ = 0.0f;
 }
 
 void AudioRecorder::AudioCallback(void* userdata, Uint8* stream, int len) {
     auto* recorder = static_cast<AudioRecorder*>(userdata);
 
-    if (recorder->audioStream_) {
-        if (SDL_AudioStreamPut(recorder->audioStream_, stream, len) == 0) {
-            int available = SDL_AudioStreamAvailable(recorder->audioStream_);
-            if (available > 0) {
-                std::vector<Uint8> buffer(available);
-                int bytesRead = SDL_AudioStreamGet(recorder->audioStream_, buffer.data(), available);
-                if (bytesRead > 0) {
-                    recorder->processAudio(buffer.data(), bytesRead);
-                }
-            }
+    // Real-time thread: copy into the ring only (no conversion, allocation, locks or I/O).
+    // Only whole frames go in, so the writer never sees a partial one.
+    const size_t frameBytes = static_cast<size_t>(recorder->deviceFrameBytes_);
+    if (frameBytes == 0 || len <= 0) return;
+    const size_t bytes = static_cast<size_t>(len);
+    const size_t space = recorder->ring_.capacity() - recorder->ring_.size();
+    const size_t fits = std::min(bytes, space / frameBytes * frameBytes);
+    const size_t pushed = recorder->ring_.push(stream, fits);
+    if (pushed < bytes) {
+        recorder->overruns_++;
+        recorder->droppedBytes_ += bytes - pushed;
+    }
+}
+
+void AudioRecorder::writerLoop() {
+    while (writerRunning_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            drainLocked();
         }
+        std::this_thread::sleep_for(std::chrono::milliseconds(kWriterIntervalMs));
     }
 }
 
-void AudioRecorder::processAudio(const Uint8* stream, int len) {
-    if (!isRecording_) return;
+void AudioRecorder::drainLocked() {
+    if (!audioStream_) return;
+    size_t bytes = 0;
+    while ((bytes = ring_.pop(drainBuffer_.data(), drainBuffer_.size())) > 0) {
+        if (SDL_AudioStreamPut(audioStream_, drainBuffer_.data(), static_cast<int>(bytes)) != 0) {
+            std::cerr << "Audio conversion failed: " << SDL_GetError() << std::endl;
+            continue;
+        }
+        convertLocked();
+    }
+}
 
-    // Write to temp WAV
-    tempWavFile_.write(reinterpret_cast<const char*>(stream), len);
+void AudioRecorder::convertLocked() {
+    const int capacityBytes = static_cast<int>(convertBuffer_.size() * sizeof(int16_t));
+    int bytesRead = 0;
+    while ((bytesRead = SDL_AudioStreamGet(audioStream_, convertBuffer_.data(), capacityBytes)) > 0) {
+        processAudio(convertBuffer_.data(), static_cast<size_t>(bytesRead) / sizeof(int16_t));
+    }
+}
 
-    // int nsamples = len / 2;
+size_t AudioRecorder::toOutputSamples(uint64_t deviceBytes) const {
+    if (deviceFrameBytes_ == 0 || deviceRate_ == 0) return 0;
+    return static_cast<size_t>(deviceBytes / deviceFrameBytes_ * sampleRate_ / deviceRate_) * channels_;
+}
 
-    if (false /*isMp3_*/) {
-        // ...
-    } else {
-        outputFile_.write(reinterpret_cast<const char*>(stream), len);
-    }
+AudioRecorder::CaptureStats AudioRecorder::getCaptureStats() const {
+    CaptureStats stats;
+    stats.overruns = overruns_;
+    stats.droppedSamples = toOutputSamples(droppedBytes_);
+    stats.bufferedSamples = toOutputSamples(ring_.size());
+    stats.capacitySamples = toOutputSamples(ring_.capacity());
+    return stats;
+}
 
-    totalBytesRecorded_ += len;
+void AudioRecorder::processAudio(const int16_t* samples, size_t sampleCount) {
+    // Writer thread (or a caller draining the ring), with mutex_ held
+    sink_.write(samples, sampleCount);
 
-    const int16_t* samples = reinterpret_cast<const int16_t*>(stream);
-    int sampleCount = len / 2;
+    if (segmentCaptureEnabled_) {
+        segmentSamples_.insert(segmentSamples_.end(), samples, samples + sampleCount);
+    }
     float sum = 0;
     float peak = 0;
-    for (int i = 0; i < sampleCount; ++i) {
+    for (size_t i = 0; i < sampleCount; ++i) {
         float sample = std::abs(samples[i]) / 32768.0f;
         sum += sample;
         peak = std::max(peak, sample);
@@ -180,50 +205,33 @@ void AudioRecorder::processAudio(const Uint8* stream, int len) {
         
         // Update last sound time if amplitude is above a minimum threshold
         if (peak > 0.01f) {
-            lastSoundTime_ = std::chrono::steady_clock::now();
+            markSound();
         }
     }
 }
 
-void AudioRecorder::writeWavHeader(std::ofstream& file, int sampleRate, int bitsPerSample, int channels, int dataSize) {
-    file << "RIFF";
-    uint32_t fileSize = 36 + dataSize;
-    file.write(reinterpret_cast<const char*>(&fileSize), 4);
-    file << "WAVE";
-    file << "fmt ";
-    uint32_t fmtSize = 16;
-    file.write(reinterpret_cast<const char*>(&fmtSize), 4);
-    uint16_t audioFormat = 1; // PCM
-    file.write(reinterpret_cast<const char*>(&audioFormat), 2);
-    uint16_t numChannels = channels;
-    file.write(reinterpret_cast<const char*>(&numChannels), 2);
-    uint32_t sampleRate32 = sampleRate;
-    file.write(reinterpret_cast<const char*>(&sampleRate32), 4);
-    uint32_t byteRate = sampleRate * channels * bitsPerSample / 8;
-    file.write(reinterpret_cast<const char*>(&byteRate), 4);
-    uint16_t blockAlign = channels * bitsPerSample / 8;
-    file.write(reinterpret_cast<const char*>(&blockAlign), 2);
-    uint16_t bitsPerSample16 = bitsPerSample;
-    file.write(reinterpret_cast<const char*>(&bitsPerSample16), 2);
-    file << "data";
-    uint32_t dataSize32 = dataSize;
-    file.write(reinterpret_cast<const char*>(&dataSize32), 4);
-}
-
-void AudioRecorder::finalizeWavFile() {
-    // Only for temp file, logic reused
-    if (tempWavFile_.is_open()) {
-        tempWavFile_.seekp(0, std::ios::beg);
-        writeWavHeader(tempWavFile_, sampleRate_, 16, channels_, totalBytesRecorded_);
-    }
-}
-
 float AudioRecorder::getSilenceDuration(float threshold) const {
     if (recentPeakAmplitude_ > threshold) {
         return 0.0f;
     }
-    auto now = std::chrono::steady_clock::now();
-    return std::chrono::duration<float>(now - lastSoundTime_).count();
+    const std::chrono::steady_clock::time_point lastSound{std::chrono::steady_clock::duration(lastSoundTicks_.load())};
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - lastSound).count();
+}
+
+bool AudioRecorder::isAudioSilent(const int16_t* samples, size_t count, float threshold) {
+    if (count == 0) return true;
+    
+    float maxAmplitude = 0.0f;
+    float totalAmplitude = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        float amplitude = std::abs(samples[i]) / 32768.0f;
+        maxAmplitude = std::max(maxAmplitude, amplitude);
+        totalAmplitude += amplitude;
+    }
+    
+    float avgAmplitude = totalAmplitude / count;
+    // Same criteria as the file-based check
+    return (avgAmplitude < threshold && maxAmplitude < threshold * 3.0f);
 }
 
 bool AudioRecorder::isAudioSilent(const std::string& wavPath, float threshold) {
@@ -268,44 +276,38 @@ bool AudioRecorder::isAudioSilent(const std::string& wavPath, float threshold) {
 bool AudioRecorder::resetToNewFile(const std::string& newOutputPath) {
     if (!isRecording_) return false;
 
-    const bool shouldLockDevice = deviceId_ != 0;
-    if (shouldLockDevice) {
-        SDL_LockAudioDevice(deviceId_);
-    }
+    // Audio captured so far still belongs to the old file
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Finalize current output file
-    if (outputFile_.is_open()) {
-        outputFile_.seekp(0, std::ios::beg);
-        writeWavHeader(outputFile_, sampleRate_, 16, channels_, totalBytesRecorded_);
-        outputFile_.close();
+    drainLocked();
+    return rotateOutputFile(newOutputPath);
+}
+
+bool AudioRecorder::takeSegment(std::vector<int16_t>& samples, const std::string& nextArchivePath) {
+    bool ok = true;
+    {
+        // Everything captured up to now belongs to this segment
+        std::lock_guard<std::mutex> lock(mutex_);
+        drainLocked();
+        samples.clear();
+        samples.swap(segmentSamples_);
+        // Keep roughly one segment's worth of capacity to avoid regrowing from zero
+        segmentSamples_.reserve(samples.size());
+        
+        if (isRecording_ && sink_.isFileOpen() && !nextArchivePath.empty()) {
+            ok = rotateOutputFile(nextArchivePath);
+        } else if (isRecording_) {
+            // Same silence bookkeeping reset as a file rotation
+            recentPeakAmplitude_ = 0.0f;
+            markSound();
+        }
     }
-    
-    // Store the old path for transcription
-    std::string oldPath = outputPath_;
-    
-    // Reset counters
-    totalBytesRecorded_ = 0;
-    outputPath_ = newOutputPath;
+    return ok;
+}
+
+bool AudioRecorder::rotateOutputFile(const std::string& newOutputPath) {
+    // Finalizes the current file before starting the new one
     currentAmplitude_ = 0.0f;
     recentPeakAmplitude_ = 0.0f;
-    lastSoundTime_ = std::chrono::steady_clock::now();
-    
-    // Open new output file
-    outputFile_.open(outputPath_, std::ios::binary);
-    if (!outputFile_.is_open()) {
-        std::cerr << "Failed to open new output file: " << outputPath_ << std::endl;
-        if (shouldLockDevice) {
-            SDL_UnlockAudioDevice(deviceId_);
-        }
-        return false;
-    }
-    
-    // Write placeholder WAV header
-    writeWavHeader(outputFile_, sampleRate_, 16, channels_, 0);
-    
-    if (shouldLockDevice) {
-        SDL_UnlockAudioDevice(deviceId_);
-    }
-    return true;
+    markSound();
+    return sink_.open(newOutputPath);
 }
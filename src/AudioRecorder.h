@@ -7,8 +7,18 @@
 #include <atomic>
 #include <fstream>
 #include <thread>
+#include <chrono>
+#include <cstdint>
+#include "RecordingSink.h"
+#include "SpscRingBuffer.h"
 // #include <lame/lame.h>
 
+// Microphone capture. The SDL audio callback only copies the device's bytes,
+// in the device's own format, into a preallocated lock-free ring; a writer
+// thread drains it every few milliseconds, converts to 16 kHz mono and does
+// the file writes (through a RecordingSink), level metering and segment
+// capture, so neither conversion nor a slow disk can stall the real-time
+// audio thread.
 class AudioRecorder {
 public:
     struct DeviceInfo {
@@ -36,21 +46,45 @@ public:
     
     // Reset recording to new file (for live transcription)
     bool resetToNewFile(const std::string& newOutputPath);
+    
+    // In-memory segment handoff (for live transcription). While enabled, captured
+    // samples are also kept in memory so each segment can go straight to
+    // WhisperEngine without writing and re-reading a WAV file.
+    void setSegmentCaptureEnabled(bool enable) { segmentCaptureEnabled_ = enable; }
+    // Move the samples captured since the last call into `samples` and start a new
+    // segment. If an output file is being written and nextArchivePath is not empty,
+    // that file is finalized and recording continues into nextArchivePath.
+    bool takeSegment(std::vector<int16_t>& samples, const std::string& nextArchivePath = "");
+    
+    // In-memory variant of isAudioSilent for captured segments
+    static bool isAudioSilent(const int16_t* samples, size_t count, float threshold = 0.01f);
+
+    // Ring buffer health for the current recording, in 16 kHz samples. An overrun
+    // is a callback whose audio didn't all fit because the writer thread fell behind.
+    struct CaptureStats {
+        uint64_t overruns = 0;
+        uint64_t droppedSamples = 0;
+        size_t bufferedSamples = 0;  // Waiting for the writer thread
+        size_t capacitySamples = 0;
+    };
+    CaptureStats getCaptureStats() const;
 
 private:
+    static constexpr int kRingSeconds = 4;        // Capture the writer thread may fall behind by
+    static constexpr int kWriterIntervalMs = 10;  // How often the writer thread drains the ring
+
     static void AudioCallback(void* userdata, Uint8* stream, int len);
-    void processAudio(const Uint8* stream, int len);
-    void writeWavHeader(std::ofstream& file, int sampleRate, int bitsPerSample, int channels, int dataSize);
-    void finalizeWavFile();
+    void writerLoop();
+    void drainLocked(); // Caller holds mutex_; the only consumer of ring_
+    void convertLocked(); // Caller holds mutex_; processes what audioStream_ has ready
+    size_t toOutputSamples(uint64_t deviceBytes) const;
+    void markSound() { lastSoundTicks_ = std::chrono::steady_clock::now().time_since_epoch().count(); }
+    void processAudio(const int16_t* samples, size_t sampleCount);
+    bool rotateOutputFile(const std::string& newOutputPath); // Caller holds mutex_
 
-    SDL_AudioStream* audioStream_ = nullptr;
+    SDL_AudioStream* audioStream_ = nullptr; // Used by the writer side only
     SDL_AudioDeviceID deviceId_ = 0;
     std::atomic<bool> isRecording_{false};
-    std::string outputPath_;
-    std::ofstream outputFile_;
-
-    std::string tempWavPath_ = "temp_recording.wav";
-    std::ofstream tempWavFile_;
 
     // Capture settings
     const int sampleRate_ = 16000;
@@ -59,10 +93,26 @@ private:
     // Stats
     std::atomic<float> currentAmplitude_{0.0f};
     std::atomic<float> recentPeakAmplitude_{0.0f};
-    std::chrono::steady_clock::time_point lastSoundTime_;
+    // steady_clock ticks; set by the writer thread, read by the GUI
+    std::atomic<int64_t> lastSoundTicks_{0};
+
+    // Audio thread -> writer thread, in the device format (converted by the writer)
+    SpscRingBuffer<Uint8> ring_;
+    int deviceFrameBytes_ = 0;             // Bytes per device sample frame; the ring holds whole frames
+    int deviceRate_ = 0;
+    std::vector<Uint8> drainBuffer_;       // A whole number of device frames
+    std::vector<int16_t> convertBuffer_;   // 16 kHz mono out of audioStream_
+    std::thread writerThread_;
+    std::atomic<bool> writerRunning_{false};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> droppedBytes_{0};
+
+    std::mutex mutex_; // Guards sink_, the segment buffer and the consumer side of ring_
+    RecordingSink sink_{sampleRate_, channels_};
 
-    std::mutex mutex_;
-    uint32_t totalBytesRecorded_ = 0;
+    // Live segment capture
+    std::atomic<bool> segmentCaptureEnabled_{false};
+    std::vector<int16_t> segmentSamples_;
 
     // MP3
     // lame_global_flags* lame_ = nullptr;
@@ -0,0 +1,44 @@
+#include "CpuInfo.h"
+#include <windows.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace CpuInfo {
+
+namespace {
+    int countPhysicalCores() {
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+        if (length == 0 || GetLastError() != ERROR_INSUFFICIENT_BUFFER) return 0;
+
+        std::vector<char> buffer(length);
+        auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+        if (!GetLogicalProcessorInformationEx(RelationProcessorCore, info, &length)) return 0;
+
+        // One record per physical core, each of variable size
+        int cores = 0;
+        for (DWORD offset = 0; offset < length;) {
+            const auto* record = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+            if (record->Relationship == RelationProcessorCore) cores++;
+            if (record->Size == 0) break;
+            offset += record->Size;
+        }
+        return cores;
+    }
+}
+
+int logicalCores() {
+    static const int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    return count;
+}
+
+int physicalCores() {
+    static const int count = [] {
+        const int cores = countPhysicalCores();
+        return cores > 0 ? std::min(cores, logicalCores()) : logicalCores();
+    }();
+    return count;
+}
+
+} // namespace CpuInfo
@@ -0,0 +1,12 @@
+#pragma once
+
+// Processor topology, queried once and cached.
+// hardware_concurrency() counts SMT siblings; whisper's matrix kernels gain
+// little from them, so thread defaults start from physical cores.
+namespace CpuInfo {
+
+int logicalCores();
+// Falls back to logicalCores() if the topology can't be read
+int physicalCores();
+
+} // namespace CpuInfo
@@ -0,0 +1,93 @@
+#include "DecodingPresets.h"
+#include "whisper.h"
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+namespace DecodingPresets {
+
+namespace {
+    // Clips up to this long are decoded as one segment by the Fastest preset
+    constexpr float kSingleSegmentSeconds = 10.0f;
+
+    std::vector<std::string> words(const std::string& text) {
+        std::vector<std::string> result;
+        std::string current;
+        for (char c : text) {
+            const unsigned char uc = static_cast<unsigned char>(c);
+            if (std::isalnum(uc) || c == '\'' || uc >= 0x80) {
+                current += static_cast<char>(std::tolower(uc));
+            } else if (!current.empty()) {
+                result.push_back(std::move(current));
+                current.clear();
+            }
+        }
+        if (!current.empty()) result.push_back(std::move(current));
+        return result;
+    }
+}
+
+const char* name(Preset preset) {
+    switch (preset) {
+        case Preset::Fastest:  return "Fastest";
+        case Preset::Balanced: return "Balanced";
+        case Preset::Accurate: return "Accurate";
+    }
+    return "Balanced";
+}
+
+const char* key(Preset preset) {
+    switch (preset) {
+        case Preset::Fastest:  return "fastest";
+        case Preset::Balanced: return "balanced";
+        case Preset::Accurate: return "accurate";
+    }
+    return "balanced";
+}
+
+Preset fromKey(const std::string& key) {
+    if (key == "fastest") return Preset::Fastest;
+    if (key == "accurate") return Preset::Accurate;
+    return Preset::Balanced;
+}
+
+whisper_full_params params(Preset preset, float clipSeconds) {
+    whisper_full_params wparams = whisper_full_default_params(
+        preset == Preset::Accurate ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY);
+    switch (preset) {
+        case Preset::Fastest:
+            wparams.temperature_inc = 0.0f; // No fallback: one decode per window
+            wparams.greedy.best_of = 1;
+            wparams.single_segment = clipSeconds <= kSingleSegmentSeconds;
+            break;
+        case Preset::Balanced:
+            break;
+        case Preset::Accurate:
+            wparams.beam_search.beam_size = 5;
+            wparams.greedy.best_of = 5; // Candidates per fallback temperature
+            break;
+    }
+    return wparams;
+}
+
+double wordErrorRate(const std::string& reference, const std::string& hypothesis) {
+    const std::vector<std::string> ref = words(reference);
+    const std::vector<std::string> hyp = words(hypothesis);
+    if (ref.empty()) return hyp.empty() ? 0.0 : 1.0;
+
+    // Word-level edit distance, one row at a time
+    std::vector<size_t> previous(hyp.size() + 1);
+    std::vector<size_t> current(hyp.size() + 1);
+    for (size_t j = 0; j <= hyp.size(); ++j) previous[j] = j;
+    for (size_t i = 1; i <= ref.size(); ++i) {
+        current[0] = i;
+        for (size_t j = 1; j <= hyp.size(); ++j) {
+            const size_t substitution = previous[j - 1] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, substitution});
+        }
+        std::swap(previous, current);
+    }
+    return static_cast<double>(previous[hyp.size()]) / static_cast<double>(ref.size());
+}
+
+} // namespace DecodingPresets
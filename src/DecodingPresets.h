@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+
+struct whisper_full_params;
+
+// Decoding strategies offered per workload.
+//   Fastest:  greedy, no temperature fallback, one segment for short clips
+//   Balanced: whisper's defaults (greedy, fallback to sampling on failure)
+//   Accurate: beam search (5 beams) with temperature fallback
+// Fallback re-decodes a window at rising temperatures when the output looks
+// like a hallucination (high compression ratio or low log-probability), which
+// is where most of the cost difference between presets comes from.
+namespace DecodingPresets {
+
+enum class Preset {
+    Fastest = 0,
+    Balanced,
+    Accurate
+};
+constexpr int kCount = 3;
+
+const char* name(Preset preset);
+// Stable identifier for settings.json
+const char* key(Preset preset);
+Preset fromKey(const std::string& key); // Balanced if unknown
+
+// whisper_full_default_params with the preset's sampling and fallback settings;
+// clipSeconds is the length of audio the params will decode
+whisper_full_params params(Preset preset, float clipSeconds);
+
+// Reference clip for the built-in benchmark (copied next to the executable
+// from whisper.cpp's samples at build time) and its transcript
+constexpr const char* kReferenceClip = "resources/jfk.wav";
+constexpr const char* kReferenceText =
+    "And so my fellow Americans, ask not what your country can do for you, ask what you can do for your country.";
+
+// Word error rate of hypothesis against reference, ignoring case and punctuation
+double wordErrorRate(const std::string& reference, const std::string& hypothesis);
+
+} // namespace DecodingPresets
@@ -0,0 +1,109 @@
+#include "EncoderCache.h"
+#include "WhisperModel.h"
+#include <whisper.h>
+#include <algorithm>
+#include <iterator>
+
+EncoderCache::EncoderCache(int capacity)
+    : capacity_(std::max(0, capacity)) {
+}
+
+EncoderCache::~EncoderCache() {
+    std::list<Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released.swap(entries_);
+    }
+    release(released);
+}
+
+void EncoderCache::release(std::list<Entry>& entries) {
+    for (Entry& entry : entries) {
+        if (!entry.state) continue;
+        if (std::shared_ptr<WhisperModel> model = entry.model.lock()) {
+            model->states().adopt(entry.state);
+        } else {
+            whisper_free_state(entry.state);
+        }
+        entry.state = nullptr;
+    }
+    entries.clear();
+}
+
+bool EncoderCache::take(const WhisperModel* model, uint64_t audioHash, size_t numSamples, Entry& entry) {
+    std::list<Entry> released;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->owner != model || it->audioHash != audioHash || it->numSamples != numSamples) continue;
+            if (it->model.expired()) {
+                released.splice(released.end(), entries_, it);
+            } else {
+                entry = std::move(*it);
+                entries_.erase(it);
+                found = true;
+            }
+            break;
+        }
+    }
+    release(released);
+    return found;
+}
+
+void EncoderCache::put(Entry entry) {
+    if (!entry.state) return;
+    std::list<Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            // The older encoding of the same clip, and states of models that were freed
+            if ((it->owner == entry.owner && it->audioHash == entry.audioHash && it->numSamples == entry.numSamples)
+                || it->model.expired()) {
+                released.splice(released.end(), entries_, it++);
+            } else {
+                ++it;
+            }
+        }
+        entries_.push_front(std::move(entry));
+        trimLocked(released);
+    }
+    release(released);
+}
+
+void EncoderCache::dropModel(const WhisperModel* model) {
+    std::list<Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->owner == model) {
+                released.splice(released.end(), entries_, it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // The model's weak references are already expired, so these are freed
+    release(released);
+}
+
+void EncoderCache::trimLocked(std::list<Entry>& released) {
+    while (static_cast<int>(entries_.size()) > capacity_) {
+        released.splice(released.end(), entries_, std::prev(entries_.end()));
+    }
+}
+
+void EncoderCache::setCapacity(int capacity) {
+    std::list<Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = std::max(0, capacity);
+        trimLocked(released);
+    }
+    release(released);
+}
+
+int EncoderCache::getCapacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <memory>
+#include <list>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+class WhisperModel;
+struct whisper_state;
+
+// Whisper states kept after a job, together with the encoder output they hold.
+// A clip that fits one 30 s window is encoded once per whisper_full call and
+// the encoding stays in the state's cross-attention cache, so decoding the
+// same clip again with another language or task can skip the mel and encoder
+// passes. States are detached from their model's pool while retained and
+// handed back to it on eviction; a model being destroyed drops its entries
+// first (dropModel), so no state outlives the context it was made from.
+// Retained states are outside both the pool capacity and the ModelCache
+// budget: each costs what a pool state does (KV and cross-attention caches
+// plus compute buffers), so capacity N adds up to N such states in total.
+class EncoderCache {
+public:
+    struct Entry {
+        std::weak_ptr<WhisperModel> model;
+        const WhisperModel* owner = nullptr; // Identity only; the model may have been freed
+        uint64_t audioHash = 0;              // Of the samples whisper saw
+        size_t numSamples = 0;
+        whisper_state* state = nullptr;
+        int languageId = -1;                 // Language token of the last decode (the detected one in auto mode)
+        bool translate = false;              // Task of the last decode
+    };
+
+    explicit EncoderCache(int capacity = 2);
+    ~EncoderCache();
+
+    EncoderCache(const EncoderCache&) = delete;
+    EncoderCache& operator=(const EncoderCache&) = delete;
+
+    // Removes and returns the entry for this clip on this model, so no other
+    // job can use the state meanwhile; put() it back when done
+    bool take(const WhisperModel* model, uint64_t audioHash, size_t numSamples, Entry& entry);
+    // Most recently used; replaces an entry for the same clip and model
+    void put(Entry entry);
+
+    // Frees every state kept for this model; called as the model is destroyed
+    void dropModel(const WhisperModel* model);
+
+    // 0 turns retention off and releases every state
+    void setCapacity(int capacity);
+    int getCapacity() const;
+
+private:
+    // Outside mutex_: handing a state back can drop the last reference to its
+    // model, whose destructor calls dropModel()
+    static void release(std::list<Entry>& entries);
+    void trimLocked(std::list<Entry>& released); // Caller holds mutex_
+
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_; // Most recently used first
+    int capacity_ = 2;
+};
@@ -1,6 +1,8 @@
 #include "Gui.h"
 #include "imgui.h"
 #include "Logger.h"
+#include "SampleConvert.h"
+#include "SpeakerAlignment.h"
 #include <SDL.h>
 #include <SDL_syswm.h>
 #include <nlohmann/json.hpp>
@@ -27,12 +29,19 @@ namespace fs = std::filesystem;
 using json = nlohmann::json;
 
 // Global state for async results
+struct PendingResult {
+    std::string text;           // Used when there is no structured result (streaming)
+    std::string historyLabel;
+    std::string path;
+    bool isLiveSegment = false;
+    std::shared_ptr<TranscriptResult> result; // Formatted on the GUI thread
+    int liveSegment = -1;
+    bool isRefinement = false;
+    bool cancelled = false;
+    bool isTranslation = false; // Second, English output of a job; never auto-pasted
+};
 static std::mutex g_resultMutex;
-static std::string g_pendingResult;
-static std::string g_pendingHistoryLabel;
-static std::string g_pendingPath;
-static bool g_hasResult = false;
-static bool g_pendingIsLiveSegment = false;
+static std::queue<PendingResult> g_pendingResults;
 
 Gui::Gui(AudioRecorder& recorder, WhisperEngine& whisper, ModelManager& models, InputManager& input)
 : recorder_(recorder), whisper_(whisper), models_(models), input_(input) {
@@ -75,8 +84,14 @@ Gui::~Gui() {
     saveHistory();
     saveSettings();
     cleanup(); // Cleanup temp recordings
-    if (transcriptionThread_.joinable()) transcriptionThread_.join();
+    streamRunning_ = false;
+    if (streamThread_.joinable()) streamThread_.join();
+    for (auto& thread : transcriptionThreads_) {
+        if (thread.joinable()) thread.join();
+    }
     if (downloadThread_.joinable()) downloadThread_.join();
+    if (calibrationThread_.joinable()) calibrationThread_.join();
+    if (presetBenchmarkThread_.joinable()) presetBenchmarkThread_.join();
     removeTrayIcon();
 }
 
@@ -152,13 +167,17 @@ void Gui::exportHistory(const std::string& format) {
         if (file.is_open()) {
             json j = json::array();
             for (const auto& item : history_) {
-                j.push_back({
+                json entry = {
                     {"text", item.text}, 
                     {"timestamp", item.timestamp},
                     {"recordingPath", item.recordingPath}
-                });
+                };
+                if (item.result) {
+                    entry["result"] = item.result->toJson();
+                }
+                j.push_back(entry);
             }
-            file << j.dump(4);
+            file << j.dump(4, ' ', false, json::error_handler_t::replace);
             file.flush();
             if (file.good()) {
                 transcriptionStatus_ = "Exported to " + filename;
@@ -169,17 +188,35 @@ void Gui::exportHistory(const std::string& format) {
         } else {
             transcriptionStatus_ = "Failed to create " + filename;
         }
-    } else if (format == "srt") {
-        std::string filename = "transcription_history_" + timestamp + ".srt";
-        std::ofstream file(filename);
+    } else if (format == "srt" || format == "vtt") {
+        const bool vtt = (format == "vtt");
+        std::string filename = "transcription_history_" + timestamp + "." + format;
+        std::ofstream file(filename, std::ios::binary);
         if (file.is_open()) {
-            int idx = 1;
-            for (auto it = history_.rbegin(); it != history_.rend(); ++it) {
-                file << idx++ << std::endl;
-                // Note: SRT format uses placeholder timestamps. Enable "Include Timestamps in Transcription" for accurate timing.
-                file << "00:00:00,000 --> 00:00:05,000" << std::endl;
-                file << it->text << std::endl << std::endl;
+            // Recordings are laid end to end in chronological order so cue times keep increasing
+            std::string out = vtt ? "WEBVTT\n\n" : "";
+            int cueIndex = 1;
+            int64_t offset = 0;
+            for (const auto& item : history_) {
+                if (item.result && !item.result->empty()) {
+                    if (vtt) {
+                        item.result->appendVtt(out, offset);
+                    } else {
+                        item.result->appendSrt(out, cueIndex, offset);
+                    }
+                    offset += std::max<int64_t>(item.result->getDuration(), item.result->getSegments().back().t1);
+                } else {
+                    // Entries without timing (older history, streamed sessions) get a nominal 5 s cue
+                    TranscriptResult placeholder = TranscriptResult::fromText(item.text, 500);
+                    if (vtt) {
+                        placeholder.appendVtt(out, offset);
+                    } else {
+                        placeholder.appendSrt(out, cueIndex, offset);
+                    }
+                    offset += 500;
+                }
             }
+            file << out;
             file.flush();
             if (file.good()) {
                 transcriptionStatus_ = "Exported to " + filename;
@@ -279,7 +316,81 @@ void Gui::render(SDL_Window* window) {
     ImGui::End();
 }
 
+bool Gui::startThreadCalibration() {
+    {
+        // Running jobs, a streaming session or the preset benchmark would skew the
+        // timings and be slowed by them; workers check calibrating_ under the same
+        // lock, so none starts once this is set
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (calibrating_.load() || benchmarkingPresets_.load() || streamDecoding_.load() || runningWorkers_ > 0) {
+            return false;
+        }
+        calibrating_ = true;
+    }
+    if (calibrationThread_.joinable()) calibrationThread_.join();
+    calibrationThread_ = std::thread([this]() {
+        whisper_.calibrateThreads();
+        calibrating_ = false;
+        calibrationFinished_ = true;
+    });
+    return true;
+}
+
+bool Gui::startPresetBenchmark() {
+    {
+        // Gated like calibration: the measured RTF must not share cores or states with other work
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (benchmarkingPresets_.load() || calibrating_.load() || streamDecoding_.load() || runningWorkers_ > 0) {
+            return false;
+        }
+        benchmarkingPresets_ = true;
+    }
+    if (presetBenchmarkThread_.joinable()) presetBenchmarkThread_.join();
+    presetBenchmarkThread_ = std::thread([this]() {
+        whisper_.benchmarkDecodingPresets();
+        benchmarkingPresets_ = false;
+        presetBenchmarkFinished_ = true;
+    });
+    return true;
+}
+
 void Gui::updateLogic(SDL_Window* window) {
+    // Persist a finished calibration, and calibrate each newly loaded model once
+    if (calibrationFinished_.exchange(false)) {
+        settings_.threadCalibrations = whisper_.getThreadCalibrations();
+        saveSettings();
+        // Start the jobs queued while it ran
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            queued = !transcriptionQueue_.empty();
+        }
+        if (queued) {
+            startTranscriptionWorkers();
+        }
+    }
+    if (presetBenchmarkFinished_.exchange(false)) {
+        settings_.presetBenchmarks = whisper_.getPresetBenchmarks();
+        saveSettings();
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            queued = !transcriptionQueue_.empty();
+        }
+        if (queued) {
+            startTranscriptionWorkers();
+        }
+    }
+    if (settings_.autoCalibrateThreads && settings_.threadsPerJob == 0 && !calibrating_.load() && !isTranscribing_.load() &&
+        !benchmarkingPresets_.load() && !streamDecoding_.load() &&
+        whisper_.getModelState() == WhisperEngine::ModelState::Ready && !whisper_.hasThreadCalibration()) {
+        const std::string model = whisper_.getModelName();
+        // Postponed while jobs, a streaming session or a benchmark run; retried once they are done
+        if (model != calibrationAttemptedModel_ && startThreadCalibration()) {
+            calibrationAttemptedModel_ = model;
+        }
+    }
+
     // Handle Hotkey for push-to-talk mode
     static bool hotkeyHeldPrevFrame = false;
     bool hotkeyHeldThisFrame = input_.isHotkeyHeld();
@@ -330,15 +441,51 @@ void Gui::updateLogic(SDL_Window* window) {
             if (settings_.liveTranscription) {
                 liveSessionTimestamp_ = currentRecordingTimestamp_;
                 liveSegmentCounter_ = 0;
+                liveSessionSamples_ = 0;
+                liveSessionSegments_ = 0;
+                liveLanguagePin_ = std::make_shared<LanguagePin>();
+                // Finished sessions no longer need their segment text
+                for (auto it = liveSessionText_.begin(); it != liveSessionText_.end();) {
+                    it = it->second.outstanding <= 0 ? liveSessionText_.erase(it) : std::next(it);
+                }
                 accumulatedLiveText_.clear();
                 hadSoundInSegment_ = false;
                 lastSoundTime_ = std::chrono::steady_clock::now();
+                // Segments are handed over in memory; files are only written for archival
+                if (!settings_.archiveLiveSegments) {
+                    currentRecordingPath_.clear();
+                }
             }
+            liveSegmentCapture_ = settings_.liveTranscription;
+            recorder_.setSegmentCaptureEnabled(liveSegmentCapture_);
 
             if (recorder_.startRecording(settings_.selectedDevice, currentRecordingPath_, false)) {
-                tempRecordings_.push_back(currentRecordingPath_);
+                if (!currentRecordingPath_.empty()) {
+                    tempRecordings_.push_back(currentRecordingPath_);
+                }
                 transcriptionStatus_ = "Recording...";
-                LOG_INFO("Recording started: " + currentRecordingPath_);
+                LOG_INFO("Recording started: " + (currentRecordingPath_.empty() ? std::string("(memory only)") : currentRecordingPath_));
+
+                // Streaming mode decodes the capture buffer continuously on its own thread
+                if (liveSegmentCapture_ && settings_.streamingTranscription) {
+                    if (streamThread_.joinable()) streamThread_.join();
+                    WhisperEngine::StreamConfig config;
+                    config.windowSeconds = settings_.streamWindowSeconds;
+                    config.stepSeconds = settings_.streamStepSeconds;
+                    config.silenceThreshold = settings_.noiseFloor;
+                    config.modelPath = dictationModelPath();
+                    whisper_.streamBegin(config);
+                    {
+                        std::lock_guard<std::mutex> lock(streamTextMutex_);
+                        streamPartialText_.clear();
+                    }
+                    streamSessionActive_ = true;
+                    streamRunning_ = true;
+                    streamDecoding_ = true;
+                    streamThread_ = std::thread([this, label = liveSessionTimestamp_]() {
+                        runStreamingLoop(label);
+                    });
+                }
             } else {
                 transcriptionStatus_ = "Error: Could not start recording.";
                 LOG_ERROR("Failed to start recording");
@@ -347,7 +494,7 @@ void Gui::updateLogic(SDL_Window* window) {
     }
     
     // Live transcription: check for silence and auto-transcribe segments
-    if (settings_.liveTranscription && recorder_.isRecording()) {
+    if (liveSegmentCapture_ && !streamSessionActive_ && recorder_.isRecording()) {
         float amplitude = recorder_.getRecentPeakAmplitude();
         
         // Track if we've had meaningful sound in this segment
@@ -362,35 +509,41 @@ void Gui::updateLogic(SDL_Window* window) {
         if (silenceDuration >= settings_.silenceDuration && hadSoundInSegment_) {
             // We have silence after speech - transcribe this segment
             std::string segmentPath = currentRecordingPath_;
-            
-            // Create new file for next segment
             liveSegmentCounter_++;
-            auto now = std::chrono::system_clock::now();
-            auto in_time_t = std::chrono::system_clock::to_time_t(now);
-            std::stringstream ss;
-            ss << std::put_time(std::localtime(&in_time_t), "%d-%m-%Y_%H-%M-%S");
-            std::string newPath = "recording_" + ss.str() + "_seg" + std::to_string(liveSegmentCounter_) + ".wav";
             
-            if (recorder_.resetToNewFile(newPath)) {
-                currentRecordingPath_ = newPath;
-                tempRecordings_.push_back(newPath);
+            // When archiving, the next segment continues into a new file
+            std::string newPath;
+            if (!segmentPath.empty()) {
+                auto now = std::chrono::system_clock::now();
+                auto in_time_t = std::chrono::system_clock::to_time_t(now);
+                std::stringstream ss;
+                ss << std::put_time(std::localtime(&in_time_t), "%d-%m-%Y_%H-%M-%S");
+                newPath = "recording_" + ss.str() + "_seg" + std::to_string(liveSegmentCounter_) + ".wav";
+            }
+            
+            auto samples = std::make_shared<std::vector<int16_t>>();
+            if (recorder_.takeSegment(*samples, newPath)) {
+                const int64_t segmentOffset = liveSessionSamples_ * 100 / 16000;
+                liveSessionSamples_ += static_cast<int64_t>(samples->size());
+                if (!newPath.empty()) {
+                    currentRecordingPath_ = newPath;
+                    tempRecordings_.push_back(newPath);
+                }
                 hadSoundInSegment_ = false;
                 
-                // Queue the previous segment for transcription (with noise check)
-                if (!AudioRecorder::isAudioSilent(segmentPath, settings_.noiseFloor)) {
-                    std::lock_guard<std::mutex> lock(queueMutex_);
-                    transcriptionQueue_.push({segmentPath, liveSessionTimestamp_, true});
-                    
+                // Queue the captured segment for transcription (with noise check)
+                if (!AudioRecorder::isAudioSilent(samples->data(), samples->size(), settings_.noiseFloor)) {
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex_);
+                        queueLiveSegmentLocked({segmentPath, liveSessionTimestamp_, true, samples, segmentOffset,
+                                                dictationModelPath()});
+                    }
+
                     // Start processing if not already
                     if (!isTranscribing_) {
                         transcriptionStatus_ = "Live: Transcribing segment...";
-                        isTranscribing_ = true;
-                        
-                        if (transcriptionThread_.joinable()) transcriptionThread_.join();
-                        transcriptionThread_ = std::thread([this]() {
-                            processTranscriptionQueue();
-                        });
                     }
+                    startTranscriptionWorkers();
                 }
             }
         }
@@ -402,9 +555,37 @@ void Gui::updateLogic(SDL_Window* window) {
             recorder_.stopRecording();
             LOG_INFO("Recording stopped: " + currentRecordingPath_);
 
-            if (settings_.autoTranscribe) {
+            // Streaming sessions flush their remaining audio on the stream thread
+            bool streamed = false;
+            if (streamSessionActive_) {
+                streamRunning_ = false;
+                streamSessionActive_ = false;
+                streamed = true;
+                liveSegmentCapture_ = false;
+                recorder_.setSegmentCaptureEnabled(false);
+                if (!isTranscribing_) {
+                    transcriptionStatus_ = "Idle";
+                }
+            }
+
+            // Live sessions hand over their final segment from memory
+            std::shared_ptr<std::vector<int16_t>> samples;
+            int64_t segmentOffset = 0;
+            if (liveSegmentCapture_) {
+                samples = std::make_shared<std::vector<int16_t>>();
+                recorder_.takeSegment(*samples);
+                segmentOffset = liveSessionSamples_ * 100 / 16000;
+                liveSessionSamples_ += static_cast<int64_t>(samples->size());
+                recorder_.setSegmentCaptureEnabled(false);
+                liveSegmentCapture_ = false;
+            }
+
+            if (streamed) {
+                // Already transcribed while recording
+            } else if (settings_.autoTranscribe) {
                 // Check if audio is silent (noise filtering)
-                bool isSilent = AudioRecorder::isAudioSilent(currentRecordingPath_, settings_.noiseFloor);
+                bool isSilent = samples ? AudioRecorder::isAudioSilent(samples->data(), samples->size(), settings_.noiseFloor)
+                                        : AudioRecorder::isAudioSilent(currentRecordingPath_, settings_.noiseFloor);
                 
                 if (isSilent) {
                     transcriptionStatus_ = "Skipped: Audio was silent.";
@@ -415,22 +596,22 @@ void Gui::updateLogic(SDL_Window* window) {
                         std::lock_guard<std::mutex> lock(queueMutex_);
                         bool isLiveSegment = settings_.liveTranscription && !liveSessionTimestamp_.empty();
                         std::string label = isLiveSegment ? liveSessionTimestamp_ : currentRecordingTimestamp_;
-                        transcriptionQueue_.push({currentRecordingPath_, label, isLiveSegment});
+                        if (isLiveSegment) {
+                            queueLiveSegmentLocked({currentRecordingPath_, label, true, samples, segmentOffset,
+                                                    dictationModelPath()});
+                        } else {
+                            queueJobLocked({currentRecordingPath_, label, false, samples, 0, dictationModelPath()});
+                        }
                         LOG_INFO("Queued for transcription: " + currentRecordingPath_);
                     }
                     
                     // Start processing if not already
                     if (!isTranscribing_) {
                         transcriptionStatus_ = "Transcribing...";
-                        isTranscribing_ = true;
-                        
-                        if (transcriptionThread_.joinable()) transcriptionThread_.join();
-                        transcriptionThread_ = std::thread([this]() {
-                            processTranscriptionQueue();
-                        });
                     } else {
                         transcriptionStatus_ = "Queued for transcription...";
                     }
+                    startTranscriptionWorkers();
                 }
             } else {
                 transcriptionStatus_ = "Recording Saved. Ready to transcribe.";
@@ -445,51 +626,150 @@ void Gui::updateLogic(SDL_Window* window) {
 
     {
         std::lock_guard<std::mutex> lock(g_resultMutex);
-        if (g_hasResult) {
-            // For live transcription, accumulate text into a single history entry
-            if (g_pendingIsLiveSegment) {
+        while (!g_pendingResults.empty()) {
+            PendingResult pending = std::move(g_pendingResults.front());
+            g_pendingResults.pop();
+
+            if (pending.cancelled) {
+                // Nothing to show; a cancelled live segment no longer holds its session open
+                transcriptionStatus_ = "Cancelled: " + pending.historyLabel;
+                auto session = liveSessionText_.find(pending.historyLabel);
+                if (pending.liveSegment >= 0 && session != liveSessionText_.end()) {
+                    if (--session->second.outstanding <= 0 && pending.historyLabel != liveSessionTimestamp_) {
+                        liveSessionText_.erase(session);
+                    }
+                }
+                continue;
+            }
+
+            // Format here so the current display settings apply; failed jobs keep only their message
+            if (pending.result) {
+                pending.text = pending.result->toText(settings_.printTimestamps);
+                if (!pending.result->ok()) {
+                    pending.result.reset();
+                }
+            }
+
+            bool paste = !pending.isTranslation;
+            if (pending.isLiveSegment && pending.liveSegment >= 0) {
+                // Live segments are composed in order into one history entry. A refined
+                // segment replaces its draft; a draft arriving after its refinement is dropped.
+                LiveSessionText& session = liveSessionText_[pending.historyLabel];
+                session.outstanding--;
+                if (session.segments.size() <= static_cast<size_t>(pending.liveSegment)) {
+                    session.segments.resize(static_cast<size_t>(pending.liveSegment) + 1);
+                }
+                LiveSegmentText& segment = session.segments[pending.liveSegment];
+                bool changed = false;
+                if (pending.isRefinement) {
+                    // A failed refinement keeps the draft
+                    if (pending.result) {
+                        paste = !segment.received; // The draft was already pasted
+                        segment = {pending.text, pending.result, true, true};
+                        changed = true;
+                    } else {
+                        LOG_WARNING("Live segment refinement failed, keeping draft: " + pending.text);
+                        paste = false;
+                    }
+                } else if (segment.refined) {
+                    paste = false;
+                } else {
+                    segment = {pending.text, pending.result, true, false};
+                    changed = true;
+                }
+
+                if (changed) {
+                    std::string text;
+                    std::shared_ptr<TranscriptResult> result;
+                    for (const LiveSegmentText& part : session.segments) {
+                        if (!text.empty() && !part.text.empty() &&
+                            !std::isspace(static_cast<unsigned char>(text.back())) &&
+                            !std::isspace(static_cast<unsigned char>(part.text.front()))) {
+                            text += " ";
+                        }
+                        text += part.text;
+                        if (part.result) {
+                            // Results already carry their session offset
+                            if (result) {
+                                result->append(*part.result, 0);
+                            } else {
+                                result = std::make_shared<TranscriptResult>(*part.result);
+                            }
+                        }
+                    }
+
+                    auto item = std::find_if(history_.begin(), history_.end(),
+                                             [&](const HistoryItem& h) { return h.timestamp == pending.historyLabel; });
+                    if (item == history_.end()) {
+                        addToHistory(text, pending.historyLabel, pending.path, result);
+                        session.composed = text;
+                    } else if (item->text == session.composed) {
+                        item->text = text;
+                        item->result = result;
+                        session.composed = text;
+                        saveHistory();
+                    } else if (!pending.isRefinement) {
+                        // Edited by hand meanwhile: leave it alone except to append new speech
+                        if (!item->text.empty() && !pending.text.empty()) {
+                            item->text += " ";
+                        }
+                        item->text += pending.text;
+                        saveHistory();
+                    }
+                }
+
+                // Drop the session once nothing more can arrive for it
+                if (session.outstanding <= 0 && pending.historyLabel != liveSessionTimestamp_) {
+                    liveSessionText_.erase(pending.historyLabel);
+                }
+            } else if (pending.isLiveSegment) {
+                // Streamed text: accumulate into a single history entry
                 bool found = false;
                 for (auto& item : history_) {
-                    if (item.timestamp == g_pendingHistoryLabel) {
-                        if (!item.text.empty() && !g_pendingResult.empty()) {
+                    if (item.timestamp == pending.historyLabel) {
+                        if (!item.text.empty() && !pending.text.empty()) {
                             char lastChar = item.text.back();
                             if (!std::isspace(static_cast<unsigned char>(lastChar)) &&
-                                !std::isspace(static_cast<unsigned char>(g_pendingResult.front()))) {
+                                !std::isspace(static_cast<unsigned char>(pending.text.front()))) {
                                 item.text += " ";
                             }
                         }
-                        item.text += g_pendingResult;
+                        item.text += pending.text;
+                        if (pending.result) {
+                            // Results already carry their session offset
+                            if (item.result) {
+                                item.result->append(*pending.result, 0);
+                            } else {
+                                item.result = pending.result;
+                            }
+                        }
                         found = true;
                         break;
                     }
                 }
                 if (!found) {
-                    addToHistory(g_pendingResult, g_pendingHistoryLabel, g_pendingPath);
+                    addToHistory(pending.text, pending.historyLabel, pending.path, pending.result);
                 } else {
                     saveHistory();
                 }
             } else {
-                addToHistory(g_pendingResult, g_pendingHistoryLabel, g_pendingPath);
+                addToHistory(pending.text, pending.historyLabel, pending.path, pending.result);
             }
             
-            if (settings_.autoPaste && g_pendingResult.find("Error:") == std::string::npos) {
-                input_.autoPaste(g_pendingResult);
-            }
-            g_pendingResult.clear();
-            g_pendingHistoryLabel.clear();
-            g_pendingPath.clear();
-            g_hasResult = false;
-            g_pendingIsLiveSegment = false;
-            
-            // Check if more items in queue
-            {
-                std::lock_guard<std::mutex> qlock(queueMutex_);
-                if (transcriptionQueue_.empty()) {
-                    isTranscribing_ = false;
-                    transcriptionStatus_ = recorder_.isRecording() ? "Recording..." : "Idle";
-                    // Apply any pending settings now that transcription is done
-                    applyPendingSettings();
-                }
+            if (paste && settings_.autoPaste && pending.text.find("Error:") == std::string::npos) {
+                input_.autoPaste(pending.text);
+            }
+        }
+
+        // Workers post their result and retire the job under g_resultMutex, so once the
+        // results are drained an empty queue with no active jobs means everything is done
+        if (isTranscribing_) {
+            std::lock_guard<std::mutex> qlock(queueMutex_);
+            if (transcriptionQueue_.empty() && activeJobs_ == 0) {
+                isTranscribing_ = false;
+                transcriptionStatus_ = recorder_.isRecording() ? "Recording..." : "Idle";
+                // Apply any pending settings now that transcription is done
+                applyPendingSettings();
             }
         }
     }
@@ -512,6 +792,11 @@ void Gui::renderControlPanel(SDL_Window* window) {
     float amplitude = recorder_.getAmplitude();
     ImGui::Text("Microphone Level:");
     ImGui::ProgressBar(amplitude * 5.0f, ImVec2(-1, 0));
+    const AudioRecorder::CaptureStats captureStats = recorder_.getCaptureStats();
+    if (captureStats.overruns > 0) {
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Capture overruns: %llu (%.2f s of audio dropped)",
+                           static_cast<unsigned long long>(captureStats.overruns), captureStats.droppedSamples / 16000.0);
+    }
 
     ImGui::Spacing();
 
@@ -552,20 +837,15 @@ void Gui::renderControlPanel(SDL_Window* window) {
             std::string label = fs::path(selectedPath).filename().string();
             {
                 std::lock_guard<std::mutex> lock(queueMutex_);
-                transcriptionQueue_.push({selectedPath, label, false});
+                queueJobLocked({selectedPath, label, false});
             }
 
             if (!isTranscribing_) {
                 transcriptionStatus_ = "Transcribing file...";
-                isTranscribing_ = true;
-
-                if (transcriptionThread_.joinable()) transcriptionThread_.join();
-                transcriptionThread_ = std::thread([this]() {
-                    processTranscriptionQueue();
-                });
             } else {
                 transcriptionStatus_ = "Queued file for transcription...";
             }
+            startTranscriptionWorkers();
         }
     }
 
@@ -589,7 +869,7 @@ void Gui::renderControlPanel(SDL_Window* window) {
                                 std::string label = entry.path().filename().string();
                                 {
                                     std::lock_guard<std::mutex> lock(queueMutex_);
-                                    transcriptionQueue_.push({entry.path().string(), label, false});
+                                    queueJobLocked({entry.path().string(), label, false});
                                 }
                                 fileCount++;
                             }
@@ -599,13 +879,7 @@ void Gui::renderControlPanel(SDL_Window* window) {
                     if (fileCount > 0) {
                         transcriptionStatus_ = "Queued " + std::to_string(fileCount) + " files for transcription...";
                         
-                        if (!isTranscribing_) {
-                            isTranscribing_ = true;
-                            if (transcriptionThread_.joinable()) transcriptionThread_.join();
-                            transcriptionThread_ = std::thread([this]() {
-                                processTranscriptionQueue();
-                            });
-                        }
+                        startTranscriptionWorkers();
                     } else {
                         transcriptionStatus_ = "No audio files found in folder.";
                     }
@@ -666,8 +940,36 @@ void Gui::renderStatusPanel() {
     ImGui::PopStyleColor();
 #endif
 
+    // Model load / warm-up state
+    const WhisperEngine::ModelState modelState = whisper_.getModelState();
+    ImGui::SameLine();
+    ImGui::Text(" | ");
+    ImGui::SameLine();
+    ImVec4 modelColor(0.2f, 0.8f, 0.2f, 1.0f);
+    if (modelState == WhisperEngine::ModelState::Loading || modelState == WhisperEngine::ModelState::WarmingUp) {
+        modelColor = ImVec4(0.8f, 0.8f, 0.2f, 1.0f);
+    } else if (modelState != WhisperEngine::ModelState::Ready) {
+        modelColor = ImVec4(1.0f, 0.6f, 0.2f, 1.0f);
+    }
+    ImGui::PushStyleColor(ImGuiCol_Text, modelColor);
+    if (modelState == WhisperEngine::ModelState::Unloaded) {
+        ImGui::Text("Model: none");
+    } else {
+        ImGui::Text("Model: %s (%s)", whisper_.getModelName().c_str(), WhisperEngine::modelStateName(modelState));
+    }
+    ImGui::PopStyleColor();
+
     if (isTranscribing_) {
-        ImGui::ProgressBar(-1.0f * (float)ImGui::GetTime() * 0.2f, ImVec2(-1, 0.0f), "Processing...");
+        renderQueue();
+    }
+
+    if (streamSessionActive_) {
+        std::lock_guard<std::mutex> lock(streamTextMutex_);
+        if (!streamPartialText_.empty()) {
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
+            ImGui::TextWrapped("Live:%s", streamPartialText_.c_str());
+            ImGui::PopStyleColor();
+        }
     }
 
     {
@@ -763,6 +1065,10 @@ void Gui::renderHistoryPanel() {
     if (ImGui::Button("Export SRT")) {
         exportHistory("srt");
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Export VTT")) {
+        exportHistory("vtt");
+    }
 
     ImGui::Separator();
 
@@ -810,7 +1116,14 @@ void Gui::renderHistoryPanel() {
                 // Bounds check before accessing history
                 if (itemIndex >= 0 && itemIndex < static_cast<int>(history_.size())) {
                     // Trim to actual string length (up to null terminator)
-                    history_[itemIndex].text = std::string(editBuffer_.c_str());
+                    HistoryItem& item = history_[itemIndex];
+                    const std::string edited(editBuffer_.c_str());
+                    if (item.result && edited != item.text) {
+                        // Hand-edited text no longer matches the segments; keep one cue over the whole recording
+                        item.result = std::make_shared<TranscriptResult>(
+                            TranscriptResult::fromText(edited, item.result->getDuration()));
+                    }
+                    item.text = edited;
                     saveHistory();
                 }
                 editingIndex_ = -1;
@@ -901,22 +1214,16 @@ void Gui::renderSettingsPanel() {
                          if (downloadThread_.joinable()) downloadThread_.join();
                          downloadThread_ = std::thread([this, modelName = models[i].name]() {
                              bool success = models_.downloadModel(modelName);
-                             if (success && !isTranscribing_.load()) {
-                                 // Load model after download only if not transcribing
-                                 whisper_.loadModel(models_.getModelPath(modelName));
+                             if (success) {
+                                 // Running jobs finish on the current model; new ones get this one
+                                 whisper_.loadModelAsync(models_.getModelPath(modelName));
                              }
                          });
                      }
                 } else {
-                    // Defer model loading if transcription is in progress
-                    if (isTranscribing_.load()) {
-                        pendingSettings_.hasPendingModel = true;
-                        pendingSettings_.pendingModel = static_cast<int>(i);
-                        LOG_INFO("Deferred model change - transcription in progress");
-                    } else {
-                        settings_.selectedModel = static_cast<int>(i);
-                        whisper_.loadModel(models_.getModelPath(models[i].name));
-                    }
+                    // Swapped in when loaded; jobs already running keep the previous model
+                    settings_.selectedModel = static_cast<int>(i);
+                    whisper_.loadModelAsync(models_.getModelPath(models[i].name));
                 }
             }
             if (isSelected) ImGui::SetItemDefaultFocus();
@@ -930,6 +1237,27 @@ void Gui::renderSettingsPanel() {
         ImGui::PopStyleColor();
     }
 
+    // Optional second model for dictation; both stay resident in the model cache
+    {
+        const bool validDictation = settings_.dictationModel >= 0 && settings_.dictationModel < static_cast<int>(models.size());
+        std::string dictationPreview = validDictation ? models[settings_.dictationModel].name : "Same as Model";
+        if (ImGui::BeginCombo("Dictation Model", dictationPreview.c_str())) {
+            if (ImGui::Selectable("Same as Model", !validDictation)) {
+                settings_.dictationModel = -1;
+            }
+            for (size_t i = 0; i < models.size(); ++i) {
+                if (!models_.isModelAvailable(models[i].name)) continue;
+                if (ImGui::Selectable(models[i].name.c_str(), settings_.dictationModel == static_cast<int>(i))) {
+                    settings_.dictationModel = static_cast<int>(i);
+                }
+            }
+            ImGui::EndCombo();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Model for microphone recordings and live transcription, e.g. a small English model.\nFiles still use the model above. Both are kept in memory within the model cache budget.");
+        }
+    }
+
     ImGui::Separator();
     ImGui::Text("Whisper Settings");
     
@@ -982,6 +1310,68 @@ void Gui::renderSettingsPanel() {
     if (ImGui::IsItemHovered()) {
         ImGui::SetTooltip("Translate non-English audio to English during transcription.");
     }
+    if (settings_.translate) {
+        ImGui::BeginDisabled();
+    }
+    ImGui::Checkbox("Also Add English Translation", &settings_.addTranslation);
+    if (settings_.translate) {
+        ImGui::EndDisabled();
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Files and recordings get a second history entry translated to English.\nClips up to 30 s reuse the first pass's encoding, so the translation only costs a decode;\nlonger files are decoded a second time in full. Skipped for audio detected as English.");
+    }
+
+    {
+        // Presets are tagged with the benchmark results for the loaded model, if measured
+        auto measured = settings_.presetBenchmarks.find(whisper_.getModelName());
+        auto presetLabel = [&](int i) {
+            std::string label = DecodingPresets::name(static_cast<DecodingPresets::Preset>(i));
+            if (measured != settings_.presetBenchmarks.end() && i < static_cast<int>(measured->second.size())) {
+                const WhisperEngine::PresetBenchmark& benchmark = measured->second[i];
+                if (benchmark.realTimeFactor > 0.0) {
+                    char buffer[64];
+                    snprintf(buffer, sizeof(buffer), " (RTF %.2f, WER %.0f%%)", benchmark.realTimeFactor,
+                             100.0 * benchmark.wordErrorRate);
+                    label += buffer;
+                }
+            }
+            return label;
+        };
+        const int current = static_cast<int>(settings_.decodingPreset);
+        if (ImGui::BeginCombo("Decoding", presetLabel(current).c_str())) {
+            for (int i = 0; i < DecodingPresets::kCount; ++i) {
+                if (ImGui::Selectable(presetLabel(i).c_str(), i == current)) {
+                    settings_.decodingPreset = static_cast<DecodingPresets::Preset>(i);
+                    whisper_.setDecodingPreset(settings_.decodingPreset);
+                }
+            }
+            ImGui::EndCombo();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Fastest: greedy, no retries at higher temperature, one segment for short clips.\n"
+                              "Balanced: whisper's defaults.\n"
+                              "Accurate: beam search with 5 beams, retries on doubtful output.\n"
+                              "RTF is decode time divided by audio length (lower is faster).");
+        }
+        if (benchmarkingPresets_.load()) {
+            ImGui::TextDisabled("Benchmarking presets...");
+        } else {
+            const bool canBenchmark = whisper_.isModelLoaded() && std::filesystem::exists(DecodingPresets::kReferenceClip)
+                                      && !isTranscribing_.load() && !calibrating_.load() && !streamDecoding_.load();
+            if (!canBenchmark) {
+                ImGui::BeginDisabled();
+            }
+            if (ImGui::Button("Benchmark Presets")) {
+                startPresetBenchmark();
+            }
+            if (!canBenchmark) {
+                ImGui::EndDisabled();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Transcribes a short reference clip with each preset on the loaded model\nand records speed (RTF) and word error rate. Available when nothing else is transcribing.");
+            }
+        }
+    }
     
     if (ImGui::Checkbox("Include Timestamps in Transcription", &settings_.printTimestamps)) {
         // Defer timestamp change if transcription is in progress
@@ -1226,6 +1616,115 @@ void Gui::renderSettingsPanel() {
         ImGui::PopID();
     }
     
+    ImGui::Separator();
+    ImGui::Text("Performance");
+    const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    if (ImGui::SliderInt("Concurrent Jobs", &settings_.concurrentJobs, 1, std::min(hardwareThreads, 16))) {
+        whisper_.setMaxConcurrentJobs(settings_.concurrentJobs);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Number of queued files transcribed at the same time.\nAll jobs share the loaded model; each one needs its own working memory.");
+    }
+    if (ImGui::SliderInt("Threads per Job", &settings_.threadsPerJob, 0, hardwareThreads,
+                         settings_.threadsPerJob == 0 ? "Auto" : "%d")) {
+        whisper_.setThreadsPerJob(settings_.threadsPerJob);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("CPU threads used by each job. Auto splits all cores between concurrent jobs.");
+    }
+    if (ImGui::SliderInt("Diarization Threads", &settings_.diarizationThreads, 0, std::max(1, hardwareThreads / 2),
+                         settings_.diarizationThreads == 0 ? "Auto" : "%d")) {
+        whisper_.setDiarizationThreads(settings_.diarizationThreads);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Threads for speaker diarization, which runs alongside transcription.\nOne file is diarized at a time, so these are split off the whisper threads of all jobs together.\nAuto uses a quarter of a job's threads.");
+    }
+    ImGui::TextDisabled("Each job uses %d threads", whisper_.getEffectiveThreadsPerJob());
+    if (calibrating_.load()) {
+        ImGui::TextDisabled("Calibrating threads...");
+    } else {
+        const bool busy = isTranscribing_.load() || benchmarkingPresets_.load() || streamDecoding_.load();
+        if (busy) {
+            ImGui::BeginDisabled();
+        }
+        if (ImGui::Button("Calibrate Threads") && whisper_.isModelLoaded()) {
+            startThreadCalibration();
+        }
+        if (busy) {
+            ImGui::EndDisabled();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Times a short test clip at several thread counts on the loaded model and keeps the fastest.\nUsed when Threads per Job is Auto. Available when nothing else is transcribing or benchmarking.");
+        }
+        auto calibration = settings_.threadCalibrations.find(whisper_.getModelName());
+        if (calibration != settings_.threadCalibrations.end()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("Best: %d threads (%.0f ms)", calibration->second.whisperThreads, calibration->second.whisperMs);
+        }
+    }
+    ImGui::Checkbox("Calibrate New Models Automatically", &settings_.autoCalibrateThreads);
+    if (ImGui::SliderInt("Model Cache (MB)", &settings_.modelCacheMB, 0, 32768)) {
+        whisper_.setModelCacheBudgetMB(settings_.modelCacheMB);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Memory for keeping recently used models loaded, so switching between them is instant.\nThe current model always stays loaded.");
+    }
+    {
+        const WhisperEngine::ModelCacheStats cache = whisper_.getModelCacheStats();
+        ImGui::TextDisabled("%d resident (%.0f MB), %llu hits, %llu misses, %llu evicted",
+                            cache.residentModels, static_cast<double>(cache.residentBytes) / (1024.0 * 1024.0),
+                            static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(cache.misses),
+                            static_cast<unsigned long long>(cache.evictions));
+    }
+    if (ImGui::Checkbox("Skip Silence", &settings_.skipSilence)) {
+        whisper_.setSkipSilence(settings_.skipSilence);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Detects speech first and only transcribes that, so long pauses cost nothing.\nTimestamps still refer to the original recording.");
+    }
+    if (ImGui::Checkbox("Fast Short Clips", &settings_.adaptiveAudioContext)) {
+        whisper_.setAdaptiveAudioContext(settings_.adaptiveAudioContext);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Clips under 20 s (live segments, short dictation) are encoded at their own length\ninstead of a padded 30 s window, several times faster. Falls back to the full window if the\nresult looks cut short or unsure. Not used by the Accurate preset.");
+    }
+    if (ImGui::SliderInt("Reusable Encodings", &settings_.retainedEncodings, 0, 8,
+                         settings_.retainedEncodings == 0 ? "Off" : "%d")) {
+        whisper_.setRetainedEncodings(settings_.retainedEncodings);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Encoder output of the last few clips up to 30 s is kept, so running one again with another\nlanguage or Translate setting skips straight to decoding. Each costs one job's working memory.");
+    }
+    if (ImGui::Checkbox("Split Long Files", &settings_.longFileChunking)) {
+        whisper_.setLongFileChunking(settings_.longFileChunking);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Cuts recordings longer than a minute at pauses and transcribes the pieces in parallel.\nMuch faster on many-core CPUs; each worker needs its own working memory.");
+    }
+    if (settings_.longFileChunking) {
+        if (ImGui::SliderInt("Chunk Workers", &settings_.chunkWorkers, 0, std::min(hardwareThreads, 32),
+                             settings_.chunkWorkers == 0 ? "Auto" : "%d")) {
+            whisper_.setChunkWorkers(settings_.chunkWorkers);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Pieces of a long file decoded at the same time. Auto uses one per four CPU threads.\nWhile other jobs run, a long file uses fewer workers rather than make them wait.");
+        }
+    }
+    ImGui::Checkbox("Reuse Previous Results", &settings_.resultCache);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Files already transcribed with the same model and settings load their saved result instead of being decoded again.\nMatched by content, so renamed copies count too.");
+    }
+    if (settings_.resultCache) {
+        if (ImGui::SliderInt("Result Cache (MB)", &settings_.resultCacheMB, 16, 4096)) {
+            resultCache_.setMaxBytes(static_cast<uint64_t>(settings_.resultCacheMB) * 1024 * 1024);
+        }
+        const ResultCache::Stats cache = resultCache_.getStats();
+        const uint64_t lookups = cache.hits + cache.misses;
+        ImGui::TextDisabled("%llu hits, %llu misses (%.0f%% hit rate)",
+                            static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(cache.misses),
+                            lookups > 0 ? 100.0 * static_cast<double>(cache.hits) / static_cast<double>(lookups) : 0.0);
+    }
+
     ImGui::Separator();
     ImGui::Text("Automation");
     ImGui::Checkbox("Auto-paste text after transcription", &settings_.autoPaste);
@@ -1269,6 +1768,38 @@ void Gui::renderSettingsPanel() {
             ImGui::SetTooltip("Minimum amplitude to consider as actual speech.\nClips below this are skipped.");
         }
         
+        const bool canRefine = !dictationModelPath().empty();
+        if (!canRefine) {
+            ImGui::BeginDisabled();
+        }
+        ImGui::Checkbox("Refine with Main Model", &settings_.refineLiveSegments);
+        if (!canRefine) {
+            ImGui::EndDisabled();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Each segment is shown and pasted as soon as the Dictation Model finishes it,\nthen transcribed again with the main model when the CPU is free; the history entry is updated with the better text.\nNeeds a Dictation Model different from the main model.");
+        }
+
+        ImGui::Checkbox("Streaming Mode", &settings_.streamingTranscription);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Transcribe continuously while you speak instead of waiting for a pause.\nText appears as a grey preview and is committed once it stops changing.\nTakes effect on the next recording.");
+        }
+        if (settings_.streamingTranscription) {
+            ImGui::SliderFloat("Stream Window (sec)", &settings_.streamWindowSeconds, 5.0f, 25.0f, "%.0f");
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Maximum audio re-decoded each step before the text is force-committed.");
+            }
+            ImGui::SliderFloat("Stream Step (sec)", &settings_.streamStepSeconds, 0.5f, 3.0f, "%.1f");
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("How often the window is re-decoded. Shorter steps show text sooner but use more CPU.");
+            }
+        }
+        
+        ImGui::Checkbox("Save Live Segments to Disk", &settings_.archiveLiveSegments);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Also write each live segment to a WAV file.\nSegments are always transcribed straight from memory; takes effect on the next recording.");
+        }
+        
         ImGui::Unindent();
     }
 }
@@ -1284,6 +1815,9 @@ void Gui::loadHistory() {
                 hi.text = item.value("text", "");
                 hi.timestamp = item.value("timestamp", "");
                 hi.recordingPath = item.value("recordingPath", "");
+                if (item.contains("result")) {
+                    hi.result = std::make_shared<TranscriptResult>(TranscriptResult::fromJson(item["result"]));
+                }
                 history_.push_back(hi);
             }
         } catch (...) {}
@@ -1295,21 +1829,28 @@ void Gui::saveHistory() {
     if (file.is_open()) {
         json j = json::array();
         for (const auto& item : history_) {
-            j.push_back({
+            json entry = {
                 {"text", item.text}, 
                 {"timestamp", item.timestamp},
                 {"recordingPath", item.recordingPath}
-            });
+            };
+            if (item.result) {
+                entry["result"] = item.result->toJson();
+            }
+            j.push_back(entry);
         }
-        file << j.dump(4);
+        // Token text can end mid UTF-8 sequence, so don't let that abort the save
+        file << j.dump(4, ' ', false, json::error_handler_t::replace);
     }
 }
 
-void Gui::addToHistory(const std::string& text, const std::string& recordingTimestamp, const std::string& recordingPath) {
+void Gui::addToHistory(const std::string& text, const std::string& recordingTimestamp, const std::string& recordingPath,
+                       std::shared_ptr<TranscriptResult> result) {
     HistoryItem item;
     item.text = text;
     item.timestamp = recordingTimestamp;
     item.recordingPath = recordingPath;
+    item.result = std::move(result);
     history_.push_back(item);
     saveHistory();
 }
@@ -1321,6 +1862,10 @@ void Gui::loadSettings() {
             json j;
             file >> j;
             settings_.selectedModel = j.value("selectedModel", -1);
+            settings_.dictationModel = j.value("dictationModel", -1);
+            settings_.modelCacheMB = j.value("modelCacheMB", 4096);
+            settings_.resultCache = j.value("resultCache", true);
+            settings_.resultCacheMB = j.value("resultCacheMB", 256);
             settings_.selectedDevice = j.value("selectedDevice", 0);
             settings_.autoPaste = j.value("autoPaste", false);
             settings_.autoTranscribe = j.value("autoTranscribe", true);
@@ -1331,12 +1876,53 @@ void Gui::loadSettings() {
             settings_.silenceThreshold = j.value("silenceThreshold", 0.02f);
             settings_.silenceDuration = j.value("silenceDuration", 1.5f);
             settings_.noiseFloor = j.value("noiseFloor", 0.005f);
+            settings_.archiveLiveSegments = j.value("archiveLiveSegments", false);
+            settings_.streamingTranscription = j.value("streamingTranscription", false);
+            settings_.streamWindowSeconds = j.value("streamWindowSeconds", 10.0f);
+            settings_.streamStepSeconds = j.value("streamStepSeconds", 1.0f);
             settings_.language = j.value("language", "en");
             settings_.translate = j.value("translate", false);
+            settings_.addTranslation = j.value("addTranslation", false);
             settings_.printTimestamps = j.value("printTimestamps", false);
             settings_.speakerDiarization = j.value("speakerDiarization", false);
             settings_.selectedSegmentationModel = j.value("selectedSegmentationModel", "");
             settings_.selectedEmbeddingModel = j.value("selectedEmbeddingModel", "");
+            settings_.concurrentJobs = j.value("concurrentJobs", 1);
+            settings_.threadsPerJob = j.value("threadsPerJob", 0);
+            settings_.diarizationThreads = j.value("diarizationThreads", 0);
+            settings_.longFileChunking = j.value("longFileChunking", false);
+            settings_.chunkWorkers = j.value("chunkWorkers", 0);
+            settings_.skipSilence = j.value("skipSilence", false);
+            settings_.adaptiveAudioContext = j.value("adaptiveAudioContext", true);
+            settings_.retainedEncodings = j.value("retainedEncodings", 2);
+            settings_.decodingPreset = DecodingPresets::fromKey(j.value("decodingPreset", std::string("balanced")));
+            if (j.contains("presetBenchmarks") && j["presetBenchmarks"].is_object()) {
+                for (const auto& item : j["presetBenchmarks"].items()) {
+                    if (!item.value().is_array()) continue;
+                    std::vector<WhisperEngine::PresetBenchmark> benchmarks;
+                    for (const json& entry : item.value()) {
+                        WhisperEngine::PresetBenchmark benchmark;
+                        benchmark.realTimeFactor = entry.value("rtf", 0.0);
+                        benchmark.wordErrorRate = entry.value("wer", -1.0);
+                        benchmarks.push_back(benchmark);
+                    }
+                    settings_.presetBenchmarks[item.key()] = benchmarks;
+                }
+            }
+            settings_.refineLiveSegments = j.value("refineLiveSegments", false);
+            settings_.autoCalibrateThreads = j.value("autoCalibrateThreads", true);
+            if (j.contains("threadCalibration") && j["threadCalibration"].is_object()) {
+                for (const auto& item : j["threadCalibration"].items()) {
+                    const json& entry = item.value();
+                    WhisperEngine::ThreadCalibration calibration;
+                    calibration.whisperThreads = entry.value("whisperThreads", 0);
+                    calibration.diarizationThreads = entry.value("diarizationThreads", 0);
+                    calibration.whisperMs = entry.value("whisperMs", 0.0);
+                    if (calibration.whisperThreads > 0) {
+                        settings_.threadCalibrations[item.key()] = calibration;
+                    }
+                }
+            }
             LOG_INFO("Settings loaded");
         } catch (...) {
             LOG_WARNING("Failed to parse settings.json");
@@ -1365,14 +1951,30 @@ void Gui::loadSettings() {
         }
     }
 
+    // Concurrency must be set before the model creates its state pool
+    whisper_.setMaxConcurrentJobs(settings_.concurrentJobs);
+    whisper_.setThreadsPerJob(settings_.threadsPerJob);
+    whisper_.setDiarizationThreads(settings_.diarizationThreads);
+    whisper_.setLongFileChunking(settings_.longFileChunking);
+    whisper_.setChunkWorkers(settings_.chunkWorkers);
+    whisper_.setSkipSilence(settings_.skipSilence);
+    whisper_.setAdaptiveAudioContext(settings_.adaptiveAudioContext);
+    whisper_.setRetainedEncodings(settings_.retainedEncodings);
+    whisper_.setDecodingPreset(settings_.decodingPreset);
+    whisper_.setPresetBenchmarks(settings_.presetBenchmarks);
+    whisper_.setThreadCalibrations(settings_.threadCalibrations);
+    whisper_.setModelCacheBudgetMB(settings_.modelCacheMB);
+    resultCache_.setMaxBytes(static_cast<uint64_t>(settings_.resultCacheMB) * 1024 * 1024);
+
     // Auto load whisper model
     if (settings_.selectedModel >= 0) {
         auto models = models_.getAvailableModels();
         if (settings_.selectedModel < static_cast<int>(models.size())) {
             std::string name = models[settings_.selectedModel].name;
             if (models_.isModelAvailable(name)) {
-                LOG_INFO("Loading whisper model: " + name);
-                whisper_.loadModel(models_.getModelPath(name));
+                // Loads and warms up in the background so the window comes up immediately
+                LOG_INFO("Preloading whisper model: " + name);
+                whisper_.loadModelAsync(models_.getModelPath(name));
             }
         }
     }
@@ -1404,6 +2006,10 @@ void Gui::saveSettings() {
     if (file.is_open()) {
         json j;
         j["selectedModel"] = settings_.selectedModel;
+        j["dictationModel"] = settings_.dictationModel;
+        j["modelCacheMB"] = settings_.modelCacheMB;
+        j["resultCache"] = settings_.resultCache;
+        j["resultCacheMB"] = settings_.resultCacheMB;
         j["selectedDevice"] = settings_.selectedDevice;
         j["autoPaste"] = settings_.autoPaste;
         j["autoTranscribe"] = settings_.autoTranscribe;
@@ -1414,12 +2020,46 @@ void Gui::saveSettings() {
         j["silenceThreshold"] = settings_.silenceThreshold;
         j["silenceDuration"] = settings_.silenceDuration;
         j["noiseFloor"] = settings_.noiseFloor;
+        j["archiveLiveSegments"] = settings_.archiveLiveSegments;
+        j["streamingTranscription"] = settings_.streamingTranscription;
+        j["streamWindowSeconds"] = settings_.streamWindowSeconds;
+        j["streamStepSeconds"] = settings_.streamStepSeconds;
         j["language"] = settings_.language;
         j["translate"] = settings_.translate;
+        j["addTranslation"] = settings_.addTranslation;
         j["printTimestamps"] = settings_.printTimestamps;
         j["speakerDiarization"] = settings_.speakerDiarization;
         j["selectedSegmentationModel"] = settings_.selectedSegmentationModel;
         j["selectedEmbeddingModel"] = settings_.selectedEmbeddingModel;
+        j["concurrentJobs"] = settings_.concurrentJobs;
+        j["threadsPerJob"] = settings_.threadsPerJob;
+        j["diarizationThreads"] = settings_.diarizationThreads;
+        j["longFileChunking"] = settings_.longFileChunking;
+        j["chunkWorkers"] = settings_.chunkWorkers;
+        j["skipSilence"] = settings_.skipSilence;
+        j["adaptiveAudioContext"] = settings_.adaptiveAudioContext;
+        j["retainedEncodings"] = settings_.retainedEncodings;
+        j["decodingPreset"] = DecodingPresets::key(settings_.decodingPreset);
+        json presetBenchmarks = json::object();
+        for (const auto& [model, benchmarks] : settings_.presetBenchmarks) {
+            json entries = json::array();
+            for (const WhisperEngine::PresetBenchmark& benchmark : benchmarks) {
+                entries.push_back({{"rtf", benchmark.realTimeFactor}, {"wer", benchmark.wordErrorRate}});
+            }
+            presetBenchmarks[model] = entries;
+        }
+        j["presetBenchmarks"] = presetBenchmarks;
+        j["refineLiveSegments"] = settings_.refineLiveSegments;
+        j["autoCalibrateThreads"] = settings_.autoCalibrateThreads;
+        json calibrations = json::object();
+        for (const auto& [model, calibration] : settings_.threadCalibrations) {
+            calibrations[model] = {
+                {"whisperThreads", calibration.whisperThreads},
+                {"diarizationThreads", calibration.diarizationThreads},
+                {"whisperMs", calibration.whisperMs}
+            };
+        }
+        j["threadCalibration"] = calibrations;
         file << j.dump(4);
         LOG_INFO("Settings saved");
     }
@@ -1430,18 +2070,6 @@ void Gui::applyPendingSettings() {
     
     LOG_INFO("Applying pending settings");
     
-    if (pendingSettings_.hasPendingModel) {
-        auto models = models_.getAvailableModels();
-        if (pendingSettings_.pendingModel >= 0 && pendingSettings_.pendingModel < static_cast<int>(models.size())) {
-            settings_.selectedModel = pendingSettings_.pendingModel;
-            std::string name = models[settings_.selectedModel].name;
-            if (models_.isModelAvailable(name)) {
-                LOG_INFO("Applying pending model: " + name);
-                whisper_.loadModel(models_.getModelPath(name));
-            }
-        }
-    }
-    
     if (pendingSettings_.hasPendingLanguage) {
         settings_.language = pendingSettings_.pendingLanguage;
         whisper_.setLanguage(settings_.language);
@@ -1522,7 +2150,7 @@ void Gui::cleanup() {
     }
     tempRecordings_.clear();
     
-    // Also delete the temp_recording.wav if it exists
+    // Left behind by older versions, which mirrored every recording into it
     try {
         if (fs::exists("temp_recording.wav")) {
             fs::remove("temp_recording.wav");
@@ -1530,66 +2158,327 @@ void Gui::cleanup() {
     } catch (...) {}
 }
 
+std::string Gui::dictationModelPath() {
+    if (settings_.dictationModel < 0 || settings_.dictationModel == settings_.selectedModel) {
+        return {};
+    }
+    auto models = models_.getAvailableModels();
+    if (settings_.dictationModel >= static_cast<int>(models.size())) return {};
+    const std::string& name = models[settings_.dictationModel].name;
+    return models_.isModelAvailable(name) ? models_.getModelPath(name) : std::string();
+}
+
+void Gui::queueLiveSegmentLocked(TranscriptionJob job) {
+    job.liveSegment = liveSessionSegments_++;
+    job.languagePin = liveLanguagePin_;
+    LiveSessionText& session = liveSessionText_[job.historyLabel];
+    queueJobLocked(job);
+    session.outstanding++;
+
+    // Draft on the dictation model now, final text from the main model when cores are free
+    if (settings_.refineLiveSegments && !job.modelPath.empty()) {
+        job.modelPath.clear();
+        job.isRefinement = true;
+        queueJobLocked(job);
+        session.outstanding++;
+    }
+}
+
+void Gui::queueJobLocked(TranscriptionJob job) {
+    job.control = std::make_shared<JobControl>();
+    job.useResultCache = settings_.resultCache;
+    job.addTranslation = settings_.addTranslation && !settings_.translate && settings_.language != "en";
+    maxWorkers_ = std::max(1, settings_.concurrentJobs);
+    transcriptionQueue_.push_back(std::move(job));
+}
+
+bool Gui::ensureModelLoaded() {
+    std::lock_guard<std::mutex> loadLock(modelLoadMutex_);
+    // A background preload may already be under way
+    if (!whisper_.waitForModel()) {
+        auto models = models_.getAvailableModels();
+        if (settings_.selectedModel >= 0 && settings_.selectedModel < static_cast<int>(models.size())) {
+            LOG_INFO("Loading whisper model for transcription");
+            whisper_.loadModel(models_.getModelPath(models[settings_.selectedModel].name));
+        }
+    }
+    return whisper_.isModelLoaded();
+}
+
+void Gui::runStreamingLoop(std::string historyLabel) {
+    const auto step = std::chrono::duration<float>(std::max(0.25f, settings_.streamStepSeconds));
+    std::vector<int16_t> captured;
+    std::vector<float> pcmf32;
+    bool reportedError = false;
+    ensureModelLoaded();
+
+    while (true) {
+        // Sleep in small slices so stopping the recording flushes promptly
+        auto wakeTime = std::chrono::steady_clock::now() + step;
+        while (streamRunning_ && std::chrono::steady_clock::now() < wakeTime) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        // Recording is already stopped when streamRunning_ drops, so this takes the last samples
+        const bool finalStep = !streamRunning_;
+
+        recorder_.takeSegment(captured);
+        pcmf32.resize(captured.size());
+        SampleConvert::s16ToFloat(captured.data(), pcmf32.data(), captured.size());
+
+        WhisperEngine::StreamUpdate update = whisper_.streamProcess(pcmf32.data(), pcmf32.size(), finalStep);
+        if (!update.error.empty()) {
+            if (!reportedError) {
+                LOG_ERROR("Streaming transcription failed: " + update.error);
+                reportedError = true;
+            }
+        } else {
+            reportedError = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(streamTextMutex_);
+            streamPartialText_ = update.partial;
+        }
+        if (!update.committed.empty()) {
+            std::lock_guard<std::mutex> lock(g_resultMutex);
+            g_pendingResults.push({update.committed, historyLabel, "", true});
+        }
+
+        if (finalStep) break;
+    }
+    streamDecoding_ = false;
+    LOG_INFO("Streaming transcription finished");
+}
+
+void Gui::startTranscriptionWorkers() {
+    isTranscribing_ = true;
+
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    // Reap workers that have left their loop; they no longer touch the queue
+    for (const std::thread::id& id : finishedWorkers_) {
+        auto it = std::find_if(transcriptionThreads_.begin(), transcriptionThreads_.end(),
+                               [&](const std::thread& thread) { return thread.get_id() == id; });
+        if (it != transcriptionThreads_.end()) {
+            it->join();
+            transcriptionThreads_.erase(it);
+        }
+    }
+    finishedWorkers_.clear();
+
+    // Jobs queued during a thread calibration or preset benchmark wait for it; updateLogic starts them
+    if (calibrating_.load() || benchmarkingPresets_.load()) return;
+
+    const int wanted = std::min(maxWorkers_, activeJobs_ + static_cast<int>(transcriptionQueue_.size()));
+    while (runningWorkers_ < wanted) {
+        runningWorkers_++;
+        transcriptionThreads_.emplace_back([this]() {
+            processTranscriptionQueue();
+        });
+    }
+}
+
 void Gui::processTranscriptionQueue() {
 while (true) {
     TranscriptionJob job;
     {
         std::lock_guard<std::mutex> lock(queueMutex_);
-        if (transcriptionQueue_.empty()) {
+        // Take the first job we may run. Live drafts are pasted as they arrive, so
+        // only one of them is transcribed at a time to keep them in order.
+        // Refinements only run when nothing else is waiting.
+        auto runnable = [this](const TranscriptionJob& queued) {
+            return !queued.isRefinement && !(queued.isLiveSegment && liveJobInFlight_);
+        };
+        // Jobs cancelled while queued are retired first, without running.
+        auto it = std::find_if(transcriptionQueue_.begin(), transcriptionQueue_.end(),
+                               [](const TranscriptionJob& queued) { return queued.control && queued.control->isCancelled(); });
+        if (it == transcriptionQueue_.end()) {
+            it = std::find_if(transcriptionQueue_.begin(), transcriptionQueue_.end(), runnable);
+        }
+        if (it == transcriptionQueue_.end()) {
+            it = std::find_if(transcriptionQueue_.begin(), transcriptionQueue_.end(),
+                              [](const TranscriptionJob& queued) { return queued.isRefinement; });
+        }
+        if (it == transcriptionQueue_.end()) {
+            runningWorkers_--;
+            finishedWorkers_.push_back(std::this_thread::get_id());
             return;
         }
-        job = transcriptionQueue_.front();
-        transcriptionQueue_.pop();
+        job = *it;
+        transcriptionQueue_.erase(it);
+        activeJobs_++;
+        runningJobs_.push_back(job);
+        if (job.isLiveSegment && !job.isRefinement) {
+            liveJobInFlight_ = true;
+        }
     }
-        
-    LOG_INFO("Starting transcription: " + job.audioPath);
-
-    std::string text;
 
-    // Ensure model is loaded
-    if (!whisper_.isModelLoaded()) {
-        auto models = models_.getAvailableModels();
-        if (settings_.selectedModel >= 0 && settings_.selectedModel < static_cast<int>(models.size())) {
-            LOG_INFO("Loading whisper model for transcription");
-            whisper_.loadModel(models_.getModelPath(models[settings_.selectedModel].name));
-        }
+    auto result = std::make_shared<TranscriptResult>();
+    JobControl* control = job.control.get();
+    // The English pass reuses the language detected by the first, never detecting again
+    std::shared_ptr<LanguagePin> languagePin = job.languagePin;
+    if (!languagePin && job.addTranslation) {
+        languagePin = std::make_shared<LanguagePin>(true);
     }
 
-    if (!whisper_.isModelLoaded()) {
-        text = "Error: No Model Loaded";
+    // Taken once below and shared by both passes
+    WhisperEngine::JobSettings settings;
+    if (control->isCancelled()) {
+        *result = TranscriptResult::failure(WhisperEngine::kCancelledError);
+    } else if (!ensureModelLoaded()) {
+        *result = TranscriptResult::failure("Error: No Model Loaded");
         LOG_ERROR("Transcription failed - no model loaded");
     } else {
-        auto startTime = std::chrono::steady_clock::now();
-        text = whisper_.transcribeFile(job.audioPath);
-        auto endTime = std::chrono::steady_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+        LOG_INFO("Starting transcription: " + (job.samples ? job.historyLabel + " (in-memory segment)" : job.audioPath));
+
+        // Files seen before with the same settings are answered from the result cache.
+        // The key and the decode use one snapshot, so a settings change between the
+        // two can't file a result under the wrong key.
+        settings = whisper_.snapshotSettings(job.modelPath);
+        uint64_t contentHash = 0;
+        std::string cacheSettings;
+        const bool cacheable = job.useResultCache && !job.samples && !job.isLiveSegment
+                               && ResultCache::hashFile(job.audioPath, contentHash);
+        if (cacheable) {
+            cacheSettings = WhisperEngine::describeSettings(settings);
+        }
 
-        if (text.find("Error:") == 0) {
-            LOG_ERROR("Transcription failed: " + text);
+        if (cacheable && resultCache_.lookup(contentHash, cacheSettings, *result)) {
+            LOG_INFO("Transcription loaded from result cache");
         } else {
-            LOG_INFO("Transcription completed in " + std::to_string(duration) + "ms");
+            auto startTime = std::chrono::steady_clock::now();
+            if (job.samples) {
+                *result = whisper_.transcribe(job.samples->data(), job.samples->size(), 16000, job.modelPath, control,
+                                              WhisperEngine::Task::Default, languagePin.get(), &settings);
+            } else {
+                *result = whisper_.transcribeFile(job.audioPath, job.modelPath, control, WhisperEngine::Task::Default,
+                                                  languagePin.get(), &settings);
+            }
+            auto endTime = std::chrono::steady_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+
+            if (control->isCancelled()) {
+                LOG_INFO("Transcription cancelled after " + std::to_string(duration) + "ms: " + job.historyLabel);
+            } else if (!result->ok()) {
+                LOG_ERROR("Transcription failed: " + result->getError());
+            } else {
+                LOG_INFO("Transcription completed in " + std::to_string(duration) + "ms");
+                if (cacheable) {
+                    resultCache_.store(contentHash, cacheSettings, *result);
+                }
+            }
+        }
+    }
+    // Live segment times are relative to the segment; place them in the session
+    if (job.liveOffset > 0) {
+        result->shiftTimes(job.liveOffset);
+    }
+    const bool cancelled = control->isCancelled();
+
+    // Optional second output in English. Short clips re-decode the encoding kept
+    // from the pass above, so this costs a decode rather than a whole job; longer
+    // ones are decoded again in full. Audio found to be English already is skipped.
+    std::shared_ptr<TranscriptResult> translation;
+    const bool english = WhisperEngine::languageCode(languagePin ? languagePin->get() : -1) == "en";
+    if (job.addTranslation && !job.isLiveSegment && !cancelled && !english && result->ok() && !result->empty()) {
+        // Same snapshot as the first pass (model, preset, silence handling), so the
+        // kept encoding matches and both outputs come from one configuration
+        WhisperEngine::JobSettings translateSettings = settings;
+        translateSettings.translate = true;
+        translateSettings.speakerDiarization = false;
+        translateSettings.numSpeakers = -1;
+        translateSettings.diarizer.clear();
+        translation = std::make_shared<TranscriptResult>(
+            job.samples ? whisper_.transcribe(job.samples->data(), job.samples->size(), 16000, job.modelPath, control,
+                                              WhisperEngine::Task::Translate, languagePin.get(), &translateSettings)
+                        : whisper_.transcribeFile(job.audioPath, job.modelPath, control, WhisperEngine::Task::Translate,
+                                                  languagePin.get(), &translateSettings));
+        if (!translation->ok() && translation->getError() != WhisperEngine::kCancelledError) {
+            LOG_ERROR("Translation failed: " + translation->getError());
+        } else if (translation->ok()) {
+            // Same audio, same speakers: label from the first pass instead of diarizing again
+            SpeakerAlignment::assignSpeakers(*translation, SpeakerAlignment::turnsFrom(*result));
         }
     }
 
         {
             std::lock_guard<std::mutex> lock(g_resultMutex);
-            g_pendingResult = text;
-            g_pendingHistoryLabel = job.historyLabel;
-            g_pendingPath = job.audioPath;
-            g_hasResult = true;
-            g_pendingIsLiveSegment = job.isLiveSegment;
+            g_pendingResults.push({"", job.historyLabel, job.audioPath, job.isLiveSegment, result,
+                                   job.liveSegment, job.isRefinement, cancelled});
+            if (translation && translation->ok()) {
+                g_pendingResults.push({"", job.historyLabel + " (English)", job.audioPath, false, translation,
+                                       -1, false, false, true});
+            }
+
+            // Retire the job together with posting its result (see updateLogic)
+            std::lock_guard<std::mutex> qlock(queueMutex_);
+            activeJobs_--;
+            runningJobs_.erase(std::find_if(runningJobs_.begin(), runningJobs_.end(),
+                                            [&](const TranscriptionJob& running) { return running.control == job.control; }));
+            if (job.isLiveSegment && !job.isRefinement) {
+                liveJobInFlight_ = false;
+            }
         }
-        
-        // Small delay to let the main thread process the result
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        // Wait until result is consumed before processing next
-        while (true) {
-            {
-                std::lock_guard<std::mutex> lock(g_resultMutex);
-                if (!g_hasResult) break;
+    }
+}
+
+void Gui::renderQueue() {
+    std::vector<TranscriptionJob> running;
+    std::vector<TranscriptionJob> queued;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        running = runningJobs_;
+        queued.assign(transcriptionQueue_.begin(), transcriptionQueue_.end());
+    }
+
+    auto jobName = [](const TranscriptionJob& job) {
+        std::string name = job.historyLabel;
+        if (job.liveSegment >= 0) name += " #" + std::to_string(job.liveSegment + 1);
+        if (job.isRefinement) name += " (refine)";
+        return name;
+    };
+
+    if (running.empty()) {
+        // Between jobs, or waiting for the model
+        ImGui::ProgressBar(-1.0f * (float)ImGui::GetTime() * 0.2f, ImVec2(-1, 0.0f), "Processing...");
+    }
+    for (const TranscriptionJob& job : running) {
+        ImGui::PushID(job.control.get());
+        const bool cancelled = job.control->isCancelled();
+        const int progress = job.control->getProgress();
+        const std::string overlay = cancelled ? jobName(job) + " - cancelling..."
+                                              : jobName(job) + " - " + std::to_string(progress) + "%";
+        ImGui::ProgressBar(static_cast<float>(progress) / 100.0f, ImVec2(-70.0f, 0.0f), overlay.c_str());
+        ImGui::SameLine();
+        if (cancelled) {
+            ImGui::BeginDisabled();
+        }
+        if (ImGui::SmallButton("Cancel")) {
+            job.control->cancel();
+        }
+        if (cancelled) {
+            ImGui::EndDisabled();
+        }
+        ImGui::PopID();
+    }
+
+    size_t waiting = 0;
+    for (const TranscriptionJob& job : queued) {
+        if (!job.control || !job.control->isCancelled()) waiting++;
+    }
+    if (waiting > 0) {
+        const std::string header = "Queued (" + std::to_string(waiting) + ")";
+        if (ImGui::CollapsingHeader(header.c_str())) {
+            for (const TranscriptionJob& job : queued) {
+                if (!job.control || job.control->isCancelled()) continue;
+                ImGui::PushID(job.control.get());
+                if (ImGui::SmallButton("Remove")) {
+                    // The worker that picks it up retires it without running it
+                    job.control->cancel();
+                }
+                ImGui::SameLine();
+                ImGui::TextUnformatted(jobName(job).c_str());
+                ImGui::PopID();
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
         }
     }
 }
@@ -3,6 +3,9 @@
 #include "WhisperEngine.h"
 #include "ModelManager.h"
 #include "InputManager.h"
+#include "ResultCache.h"
+#include "JobControl.h"
+#include "LanguagePin.h"
 #include "Logger.h"
 #include <SDL.h>
 #include <vector>
@@ -11,7 +14,9 @@
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <deque>
 #include <memory>
+#include <map>
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -44,6 +49,10 @@ private:
     // Settings
     struct Settings {
         int selectedModel = -1;
+        int dictationModel = -1;         // Model for microphone recordings and live mode (-1 = same as selectedModel)
+        int modelCacheMB = 4096;         // Resident model budget for the model cache
+        bool resultCache = true;         // Reuse results for files already transcribed with the same settings
+        int resultCacheMB = 256;         // Disk budget for cached results
         int selectedDevice = 0;
         bool autoPaste = false;
         bool autoTranscribe = true;
@@ -54,20 +63,37 @@ private:
         float silenceThreshold = 0.02f; // Silence detection threshold for live mode
         float silenceDuration = 1.5f;   // Seconds of silence before auto-transcribe
         float noiseFloor = 0.005f;      // Minimum amplitude to consider as speech
+        bool archiveLiveSegments = false; // Also write each live segment to a WAV file
+        bool refineLiveSegments = false; // Re-transcribe live segments with the main model after the dictation-model draft
+        bool streamingTranscription = false; // Live mode re-decodes a sliding window instead of waiting for silence
+        float streamWindowSeconds = 10.0f;   // Max uncommitted audio in streaming mode
+        float streamStepSeconds = 1.0f;      // Decode interval in streaming mode
         // Whisper-specific settings
         std::string language = "en";    // Language code (en, es, fr, etc., or "auto" for auto-detect)
         bool translate = false;          // Translate to English
+        bool addTranslation = false;     // File and recording jobs also produce an English translation
         bool printTimestamps = false;    // Print timestamps in transcription
         bool speakerDiarization = false; // Enable speaker identification
+        DecodingPresets::Preset decodingPreset = DecodingPresets::Preset::Balanced;
+        std::map<std::string, std::vector<WhisperEngine::PresetBenchmark>> presetBenchmarks; // By model file name
         // Speaker diarization model selection
         std::string selectedSegmentationModel;  // Name of selected segmentation model
         std::string selectedEmbeddingModel;     // Name of selected embedding model
+        // Concurrency
+        int concurrentJobs = 1;          // Transcription jobs run in parallel on the loaded model
+        int threadsPerJob = 0;           // CPU threads per job (0 = auto: cores / concurrent jobs)
+        int diarizationThreads = 0;      // Of each job's threads, given to diarization (0 = auto)
+        bool longFileChunking = false;   // Split long recordings at silences and decode chunks in parallel
+        int chunkWorkers = 0;            // Parallel chunk decoders for long files (0 = auto)
+        bool skipSilence = false;        // VAD pre-pass: cut silence out before whisper
+        bool adaptiveAudioContext = true; // Encode short clips with a shorter audio context
+        int retainedEncodings = 2;       // Short clips whose encoder output is kept for re-decoding (0 = off)
+        bool autoCalibrateThreads = true; // Tune thread counts the first time each model is loaded
+        std::map<std::string, WhisperEngine::ThreadCalibration> threadCalibrations; // By model file name
     } settings_;
     
     // Pending settings changes (applied after transcription completes)
     struct PendingSettings {
-        bool hasPendingModel = false;
-        int pendingModel = -1;
         bool hasPendingLanguage = false;
         std::string pendingLanguage;
         bool hasPendingTranslate = false;
@@ -81,7 +107,6 @@ private:
         std::string pendingEmbeddingModel;
         
         void clear() {
-            hasPendingModel = false;
             hasPendingLanguage = false;
             hasPendingTranslate = false;
             hasPendingTimestamps = false;
@@ -90,7 +115,7 @@ private:
         }
         
         bool hasAny() const {
-            return hasPendingModel || hasPendingLanguage || hasPendingTranslate ||
+            return hasPendingLanguage || hasPendingTranslate ||
                    hasPendingTimestamps || hasPendingDiarization || hasPendingDiarizationModels;
         }
     } pendingSettings_;
@@ -105,12 +130,14 @@ private:
         std::string text;
         std::string timestamp;      // Display timestamp (when recorded)
         std::string recordingPath;  // Path to the recording file
+        std::shared_ptr<TranscriptResult> result; // Segment timing for exports; null for streamed or older entries
     };
     std::vector<HistoryItem> history_;
     void loadHistory();
     void saveHistory();
-    void addToHistory(const std::string& text, const std::string& recordingTimestamp, const std::string& recordingPath);
-    void exportHistory(const std::string& format); // Export history to file (txt, json, srt)
+    void addToHistory(const std::string& text, const std::string& recordingTimestamp, const std::string& recordingPath,
+                      std::shared_ptr<TranscriptResult> result = nullptr);
+    void exportHistory(const std::string& format); // Export history to file (txt, json, srt, vtt)
     
     // Inline editing state
     int editingIndex_ = -1;          // Index of history item being edited (-1 = none)
@@ -131,13 +158,38 @@ private:
     std::string lastTranscription_;
     
     struct TranscriptionJob {
-        std::string audioPath;
+        std::string audioPath;      // Source file, or the archived copy of an in-memory segment
         std::string historyLabel;
         bool isLiveSegment = false;
+        std::shared_ptr<const std::vector<int16_t>> samples; // 16 kHz mono PCM; used instead of audioPath when set
+        int64_t liveOffset = 0;     // Start of a live segment within its session (centiseconds)
+        std::string modelPath;      // Model for this job; empty uses the loaded model
+        int liveSegment = -1;       // Index of a live segment within its session
+        bool isRefinement = false;  // Second pass of a live segment on the main model
+        std::shared_ptr<JobControl> control; // Progress and cancellation; set when queued
+        std::shared_ptr<LanguagePin> languagePin; // Shared by a live session's segments (auto-detect mode)
+        // Settings as they were when queued; workers never read settings_
+        bool useResultCache = false;
+        bool addTranslation = false; // Also produce an English version (source language isn't English)
     };
-    std::queue<TranscriptionJob> transcriptionQueue_;
+    std::deque<TranscriptionJob> transcriptionQueue_;
     std::mutex queueMutex_;
-    void processTranscriptionQueue(); // Process items in the transcription queue
+    int runningWorkers_ = 0;          // Worker threads alive (guarded by queueMutex_)
+    int maxWorkers_ = 1;              // settings_.concurrentJobs when the last job was queued (guarded by queueMutex_)
+    int activeJobs_ = 0;              // Jobs currently being transcribed (guarded by queueMutex_)
+    std::vector<TranscriptionJob> runningJobs_; // For the queue view (guarded by queueMutex_)
+    bool liveJobInFlight_ = false;    // Live segments run one at a time to keep text in order
+    std::mutex modelLoadMutex_;       // Serializes lazy model loading between workers
+    bool ensureModelLoaded();         // Load the selected model if needed (worker threads)
+    std::string dictationModelPath(); // Model for microphone jobs, empty if it's the loaded one
+    // Queue a job with a snapshot of the settings it runs with (caller holds queueMutex_)
+    void queueJobLocked(TranscriptionJob job);
+    // Queue a live segment (caller holds queueMutex_), plus its refinement pass if enabled
+    void queueLiveSegmentLocked(TranscriptionJob job);
+    ResultCache resultCache_;         // Finished file transcriptions by content and settings
+    void startTranscriptionWorkers(); // Spawn workers for queued jobs, up to maxWorkers_
+    void processTranscriptionQueue(); // Worker loop: process items in the transcription queue
+    void renderQueue();               // Running jobs with progress, queued jobs, cancel buttons
 
     // Queued actions from other threads
     std::atomic<bool> startRecordingRequest_{false};
@@ -146,9 +198,23 @@ private:
 
     std::string currentRecordingPath_;
     std::string currentRecordingTimestamp_; // When recording started
-    std::thread transcriptionThread_;
+    std::vector<std::thread> transcriptionThreads_;
+    std::vector<std::thread::id> finishedWorkers_; // Exited workers not yet joined (guarded by queueMutex_)
     std::thread downloadThread_;
 
+    // Thread calibration runs in the background; results are persisted on the GUI thread
+    std::thread calibrationThread_;
+    std::atomic<bool> calibrating_{false};
+    std::atomic<bool> calibrationFinished_{false};
+    std::string calibrationAttemptedModel_; // Auto-calibration runs once per model per session
+    bool startThreadCalibration(); // False while jobs are running
+
+    // Decoding preset benchmark, run like calibration
+    std::thread presetBenchmarkThread_;
+    std::atomic<bool> benchmarkingPresets_{false};
+    std::atomic<bool> presetBenchmarkFinished_{false};
+    bool startPresetBenchmark(); // False while jobs, a calibration or a streaming session run
+
     bool isHidden_ = false;
     std::vector<std::string> tempRecordings_; // Track temp files to cleanup
     
@@ -159,7 +225,35 @@ private:
     std::chrono::steady_clock::time_point lastSoundTime_;
     bool hadSoundInSegment_ = false;
     int liveSegmentCounter_ = 0;
+    int64_t liveSessionSamples_ = 0;   // Samples handed over so far in this live session
+    bool liveSegmentCapture_ = false;  // Current recording hands live segments over in memory
+    
+    // Streaming live transcription
+    std::thread streamThread_;
+    std::atomic<bool> streamRunning_{false};
+    std::atomic<bool> streamDecoding_{false}; // streamThread_ is running, final flush included
+    bool streamSessionActive_ = false;  // Current recording is transcribed by streamThread_
+    std::mutex streamTextMutex_;
+    std::string streamPartialText_;     // Tentative text shown in the status panel
+    void runStreamingLoop(std::string historyLabel);
     std::string liveSessionTimestamp_; // Session timestamp for grouping live segments
+    int liveSessionSegments_ = 0;      // Segments queued so far in this live session
+    std::shared_ptr<LanguagePin> liveLanguagePin_; // Language detected for this live session
+
+    // Per-segment text of live sessions with results outstanding, so a refined
+    // segment can replace its draft in the history entry (GUI thread only)
+    struct LiveSegmentText {
+        std::string text;
+        std::shared_ptr<TranscriptResult> result;
+        bool received = false;
+        bool refined = false;
+    };
+    struct LiveSessionText {
+        std::vector<LiveSegmentText> segments;
+        std::string composed;   // Text last written to the history entry
+        int outstanding = 0;    // Queued jobs (drafts and refinements) without a result yet
+    };
+    std::map<std::string, LiveSessionText> liveSessionText_; // By history label
     std::string accumulatedLiveText_;  // Accumulated text from live transcription session
     
     NOTIFYICONDATAA nid_{};
@@ -0,0 +1,28 @@
+#pragma once
+#include <atomic>
+#include <algorithm>
+
+// Cancellation flag and progress of one transcription job, shared between the
+// GUI and the worker running it. whisper and diarization poll isCancelled()
+// from their abort/progress callbacks, so a cancelled job releases its
+// threads within one decoder step.
+class JobControl {
+public:
+    void cancel() { cancelled_ = true; }
+    bool isCancelled() const { return cancelled_; }
+
+    void setDecodeProgress(int percent) { decode_ = percent; }
+    void setDiarizationProgress(int percent) { diarization_ = percent; }
+    void setDiarizing(bool diarizing) { diarizing_ = diarizing; }
+    // 0-100; the slower of decoding and diarization while both run
+    int getProgress() const {
+        const int decode = decode_;
+        return diarizing_ ? std::min(decode, diarization_.load()) : decode;
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> diarizing_{false};
+    std::atomic<int> decode_{0};
+    std::atomic<int> diarization_{0};
+};
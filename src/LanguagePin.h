@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+
+// Spoken language of a live session or file in auto-detect mode.
+// Left to itself, whisper detects the language of every clip it is given,
+// which costs an extra encoder pass per clip and lets short clips flip
+// between languages. The first confident detection is pinned and used for
+// the rest of the session; a decode whose tokens come out unsure un-pins it,
+// so the next clip is checked again.
+// A pin shared by several passes over the same audio (a transcription and its
+// English translation) keeps the first detection whatever its confidence:
+// the audio can't change language between passes, so detecting again would
+// only repeat the work.
+class LanguagePin {
+public:
+    static constexpr float kMinDetectionProbability = 0.7f;
+    static constexpr float kMinTokenProbability = 0.4f; // Mean over a decode's text tokens
+
+    explicit LanguagePin(bool sameAudio = false) : sameAudio_(sameAudio) {}
+
+    // Pinned language id, or -1 if the next clip needs detecting
+    int get() const { return language_; }
+
+    // Pins languageId if the detection was confident enough; returns whether it did
+    bool detected(int languageId, float probability) {
+        if (languageId < 0 || (!sameAudio_ && probability < kMinDetectionProbability)) return false;
+        language_ = languageId;
+        return true;
+    }
+
+    // Result of a decode that relied on the pinned languageId; returns whether it was un-pinned
+    bool decoded(int languageId, float meanTokenProbability) {
+        if (sameAudio_ || meanTokenProbability >= kMinTokenProbability) return false;
+        return language_.compare_exchange_strong(languageId, -1);
+    }
+
+    void reset() { language_ = -1; }
+
+private:
+    std::atomic<int> language_{-1};
+    const bool sameAudio_;
+};
@@ -0,0 +1,91 @@
+#include "ModelCache.h"
+#include "WhisperModel.h"
+#include "Logger.h"
+
+std::shared_ptr<WhisperModel> ModelCache::acquire(const std::string& path, int poolCapacity) {
+    auto lookup = [this, &path]() -> std::shared_ptr<WhisperModel> {
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->path == path) {
+                entries_.splice(entries_.begin(), entries_, it);
+                stats_.hits++;
+                return it->model;
+            }
+        }
+        return nullptr;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (std::shared_ptr<WhisperModel> model = lookup()) return model;
+    }
+
+    std::lock_guard<std::mutex> loadLock(loadMutex_);
+    {
+        // Someone else may have loaded it while we waited
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (std::shared_ptr<WhisperModel> model = lookup()) return model;
+        stats_.misses++;
+    }
+
+    WhisperModel::UnloadHook unloadHook;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unloadHook = unloadHook_;
+    }
+    std::shared_ptr<WhisperModel> model = WhisperModel::load(path, poolCapacity, std::move(unloadHook));
+    if (!model) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_front({path, model});
+    stats_.residentBytes += model->getSizeBytes();
+    stats_.residentModels++;
+    LOG_INFO("Model cache: loaded " + model->getName() + " (" + std::to_string(model->getSizeBytes() >> 20) + " MB, "
+             + std::to_string(stats_.residentBytes >> 20) + " MB resident)");
+    evictLocked();
+    return model;
+}
+
+void ModelCache::evictLocked() {
+    // The most recently used model always stays, even if it alone is over budget
+    auto it = entries_.end();
+    while (stats_.residentBytes > budgetBytes_ && entries_.size() > 1 && it != std::next(entries_.begin())) {
+        --it;
+        if (it->path == pinned_) continue;
+        LOG_INFO("Model cache: evicting " + it->model->getName());
+        stats_.residentBytes -= it->model->getSizeBytes();
+        stats_.residentModels--;
+        stats_.evictions++;
+        it = entries_.erase(it);
+    }
+}
+
+void ModelCache::pin(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pinned_ = path;
+    evictLocked();
+}
+
+void ModelCache::setBudgetBytes(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budgetBytes_ = bytes;
+    evictLocked();
+}
+
+void ModelCache::setPoolCapacity(int capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Entry& entry : entries_) {
+        entry.model->states().setCapacity(capacity);
+    }
+}
+
+void ModelCache::setUnloadHook(WhisperModel::UnloadHook hook) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unloadHook_ = std::move(hook);
+}
+
+ModelCache::Stats ModelCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.budgetBytes = budgetBytes_;
+    return stats;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "WhisperModel.h"
+#include <memory>
+#include <string>
+#include <list>
+#include <mutex>
+#include <cstdint>
+
+
+// Keeps recently used whisper models resident under a memory budget.
+// Lookups move a model to the front of an LRU list; loading one pushes the
+// least recently used unpinned models out until the total fits. Evicting only
+// drops the cache's reference, so a job still running on an evicted model
+// keeps it alive until it finishes. The budget covers model weights only;
+// whisper states (pooled or kept by the EncoderCache) come on top.
+class ModelCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t residentBytes = 0;
+        uint64_t budgetBytes = 0;
+        int residentModels = 0;
+    };
+
+    // Returns the cached model or loads it; null if loading fails
+    std::shared_ptr<WhisperModel> acquire(const std::string& path, int poolCapacity);
+
+    // The pinned model (the engine's current one) is never evicted
+    void pin(const std::string& path);
+    void setBudgetBytes(uint64_t bytes);
+    void setPoolCapacity(int capacity); // Applied to every resident model
+    // Given to every model loaded from now on
+    void setUnloadHook(WhisperModel::UnloadHook hook);
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<WhisperModel> model;
+    };
+
+    void evictLocked(); // Caller holds mutex_
+
+    mutable std::mutex mutex_;
+    std::mutex loadMutex_;    // One load at a time; a second request for the same file waits and then hits
+    std::list<Entry> entries_; // Most recently used first
+    std::string pinned_;
+    WhisperModel::UnloadHook unloadHook_;
+    uint64_t budgetBytes_ = 4096ull * 1024 * 1024;
+    Stats stats_;
+};
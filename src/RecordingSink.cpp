@@ -0,0 +1,131 @@
+#include "RecordingSink.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    constexpr size_t kHeaderBytes = 44;
+    // RIFF sizes are 32-bit
+    constexpr uint64_t kMaxDataBytes = 0xFFFFFFFFull - 36;
+
+    void putU16(char* p, uint16_t v) { std::memcpy(p, &v, 2); }
+    void putU32(char* p, uint32_t v) { std::memcpy(p, &v, 4); }
+}
+
+RecordingSink::RecordingSink(int sampleRate, int channels)
+    : sampleRate_(sampleRate), channels_(channels) {
+}
+
+RecordingSink::~RecordingSink() {
+    close();
+}
+
+bool RecordingSink::open(const std::string& path) {
+    close();
+    path_ = path;
+    blockOffset_ = 0;
+    dataBytes_ = 0;
+    checkpointBytes_ = 0;
+    failed_ = false;
+    if (path_.empty()) return true;
+
+    file_ = std::fopen(path_.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Failed to open recording file: " << path_ << std::endl;
+        return false;
+    }
+    // Unbuffered: blocks already arrive whole, so a stdio buffer would only add
+    // a copy and split them into its own write sizes
+    if (std::setvbuf(file_, nullptr, _IONBF, 0) != 0) {
+        std::cerr << "Recording file stays buffered: " << path_ << std::endl;
+    }
+    // The placeholder header leads the first block, so every flush lands on a block boundary
+    block_.reserve(kBlockBytes);
+    appendHeader(block_, 0);
+    return true;
+}
+
+bool RecordingSink::close() {
+    if (!file_) {
+        block_.clear();
+        return !failed_;
+    }
+    if (!block_.empty()) {
+        writeAt(blockOffset_, block_.data(), block_.size());
+        block_.clear();
+    }
+    patchHeader(dataBytes_);
+    if (std::fclose(file_) != 0) failed_ = true;
+    file_ = nullptr;
+    if (failed_) {
+        std::cerr << "Failed to write recording file: " << path_ << std::endl;
+    }
+    return !failed_;
+}
+
+void RecordingSink::write(const int16_t* samples, size_t count) {
+    const size_t bytes = count * sizeof(int16_t);
+    dataBytes_ += bytes;
+    if (!file_) return;
+
+    const char* data = reinterpret_cast<const char*>(samples);
+    size_t done = 0;
+    while (done < bytes) {
+        const size_t n = std::min(bytes - done, kBlockBytes - block_.size());
+        block_.insert(block_.end(), data + done, data + done + n);
+        done += n;
+        if (block_.size() == kBlockBytes) {
+            flushBlock();
+        }
+    }
+}
+
+void RecordingSink::flushBlock() {
+    writeAt(blockOffset_, block_.data(), block_.size());
+    blockOffset_ += block_.size();
+    block_.clear();
+
+    // Everything up to blockOffset_ is on disk; let the header cover it now and then
+    const uint64_t onDisk = blockOffset_ - kHeaderBytes;
+    if (onDisk - checkpointBytes_ >= kCheckpointBytes) {
+        patchHeader(onDisk);
+    }
+}
+
+void RecordingSink::patchHeader(uint64_t dataBytes) {
+    std::vector<char> header;
+    appendHeader(header, dataBytes);
+    writeAt(0, header.data(), header.size());
+    checkpointBytes_ = dataBytes;
+}
+
+void RecordingSink::writeAt(uint64_t offset, const char* data, size_t size) {
+#ifdef _WIN32
+    const bool positioned = _fseeki64(file_, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+    const bool positioned = fseeko(file_, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    if (!positioned || std::fwrite(data, 1, size, file_) != size) {
+        failed_ = true;
+    }
+}
+
+void RecordingSink::appendHeader(std::vector<char>& out, uint64_t dataBytes) const {
+    const uint32_t dataSize = static_cast<uint32_t>(std::min(dataBytes, kMaxDataBytes));
+    const uint16_t blockAlign = static_cast<uint16_t>(channels_ * 2);
+    char header[kHeaderBytes];
+    std::memcpy(header, "RIFF", 4);
+    putU32(header + 4, 36 + dataSize);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    putU32(header + 16, 16);
+    putU16(header + 20, 1); // PCM
+    putU16(header + 22, static_cast<uint16_t>(channels_));
+    putU32(header + 24, static_cast<uint32_t>(sampleRate_));
+    putU32(header + 28, static_cast<uint32_t>(sampleRate_) * blockAlign);
+    putU16(header + 32, blockAlign);
+    putU16(header + 34, 16);
+    std::memcpy(header + 36, "data", 4);
+    putU32(header + 40, dataSize);
+    out.insert(out.end(), header, header + kHeaderBytes);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Destination of a microphone recording: a 16-bit PCM WAV file, or nothing at
+// all for memory-only live sessions (their segments are handed over from the
+// recorder's segment buffer). Samples are collected into kBlockBytes blocks
+// at block-multiple file offsets (the 44-byte header is part of the first
+// block) and each goes to the OS as one write through an unbuffered FILE*,
+// once per ~8 s of audio instead of a small write per audio callback. The
+// memory buffer itself isn't sector-aligned and the OS cache is still used
+// (no FILE_FLAG_NO_BUFFERING). The header's sizes are patched at checkpoints
+// and on close, keeping a crashed recording playable up to the last checkpoint.
+// Not thread-safe; AudioRecorder serializes access through its mutex.
+class RecordingSink {
+public:
+    static constexpr size_t kBlockBytes = 256 * 1024;
+    static constexpr uint64_t kCheckpointBytes = 4 * kBlockBytes;
+
+    RecordingSink(int sampleRate, int channels);
+    ~RecordingSink();
+
+    RecordingSink(const RecordingSink&) = delete;
+    RecordingSink& operator=(const RecordingSink&) = delete;
+
+    // Closes the current file and starts a new one; an empty path records to memory only
+    bool open(const std::string& path);
+    // Writes the pending block and the final header; false if any write failed
+    bool close();
+
+    void write(const int16_t* samples, size_t count);
+
+    bool isFileOpen() const { return file_ != nullptr; }
+    bool isMemoryOnly() const { return path_.empty(); }
+    const std::string& path() const { return path_; }
+    // PCM bytes written since open(), including any still pending
+    uint64_t dataBytes() const { return dataBytes_; }
+
+private:
+    void appendHeader(std::vector<char>& out, uint64_t dataBytes) const;
+    void flushBlock();
+    void patchHeader(uint64_t dataBytes);
+    void writeAt(uint64_t offset, const char* data, size_t size);
+
+    const int sampleRate_;
+    const int channels_;
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    std::vector<char> block_;   // Bytes destined for file offset blockOffset_
+    uint64_t blockOffset_ = 0;
+    uint64_t dataBytes_ = 0;
+    uint64_t checkpointBytes_ = 0; // Data size the header on disk reports
+    bool failed_ = false;
+};
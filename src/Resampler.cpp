@@ -0,0 +1,153 @@
+#include "Resampler.h"
+#include "SampleConvert.h"
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+namespace {
+    constexpr int kZeroCrossings = 16;     // Sinc lobes on each side of the centre
+    constexpr double kRolloff = 0.94;      // Passband edge as a fraction of the lower Nyquist
+    constexpr double kKaiserBeta = 8.6;    // ~85 dB stopband
+    constexpr int kMaxPhases = 4096;
+    constexpr double kPi = 3.14159265358979323846;
+
+    // Zeroth-order modified Bessel function, for the Kaiser window
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        const double halfX = x / 2.0;
+        for (int k = 1; k < 64; ++k) {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+}
+
+bool Resampler::configure(int inputRate, int outputRate) {
+    if (inputRate <= 0 || outputRate <= 0) return false;
+
+    const int g = std::gcd(inputRate, outputRate);
+    const int up = outputRate / g;
+    const int down = inputRate / g;
+    if (up > kMaxPhases) return false;
+
+    inputRate_ = inputRate;
+    outputRate_ = outputRate;
+    upFactor_ = up;
+    downFactor_ = down;
+    coeffs_.clear();
+
+    if (isPassthrough()) {
+        tapsPerPhase_ = 1;
+        reset();
+        return true;
+    }
+
+    // When downsampling the kernel widens in input samples by the decimation ratio
+    const double ratio = std::max(1.0, static_cast<double>(down) / up);
+    const int taps = static_cast<int>(std::ceil(2.0 * kZeroCrossings * ratio));
+    tapsPerPhase_ = (taps + 7) / 8 * 8;
+
+    // Prototype low-pass at the upsampled rate inputRate * L
+    const size_t length = static_cast<size_t>(up) * tapsPerPhase_;
+    const double cutoff = kRolloff * 0.5 / std::max(up, down); // cycles per upsampled sample
+    // Odd-length prototype (last tap left at zero) so the delay is a whole upsampled sample
+    const double centre = static_cast<double>(length / 2 - 1);
+    const double i0Beta = besselI0(kKaiserBeta);
+
+    std::vector<double> prototype(length, 0.0);
+    for (size_t k = 0; k + 1 < length; ++k) {
+        const double t = static_cast<double>(k) - centre;
+        const double x = 2.0 * cutoff * t;
+        const double sinc = (std::fabs(x) < 1e-12) ? 1.0 : std::sin(kPi * x) / (kPi * x);
+        const double r = t / centre;
+        const double window = besselI0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+        // Gain of L makes up for the zeros inserted by upsampling
+        prototype[k] = 2.0 * cutoff * sinc * window * up;
+    }
+
+    // Split into phases, each reversed so it runs forward over the input history
+    coeffs_.resize(length);
+    for (int p = 0; p < up; ++p) {
+        for (int i = 0; i < tapsPerPhase_; ++i) {
+            const size_t k = static_cast<size_t>(p) + static_cast<size_t>(tapsPerPhase_ - 1 - i) * up;
+            coeffs_[static_cast<size_t>(p) * tapsPerPhase_ + i] = static_cast<float>(prototype[k]);
+        }
+    }
+
+    reset();
+    return true;
+}
+
+void Resampler::reset() {
+    history_.assign(static_cast<size_t>(tapsPerPhase_ - 1), 0.0f);
+    historyStart_ = 0;
+    inputCount_ = 0;
+    outputCount_ = 0;
+    // Start half a filter in so output k is centred on input time k / outputRate
+    const uint64_t length = static_cast<uint64_t>(upFactor_) * tapsPerPhase_;
+    nextPosition_ = (isPassthrough() ? 0 : length / 2 - 1) + static_cast<uint64_t>(tapsPerPhase_ - 1) * upFactor_;
+}
+
+uint64_t Resampler::outputLength(uint64_t inputFrames) const {
+    return (inputFrames * upFactor_ + downFactor_ - 1) / downFactor_;
+}
+
+void Resampler::process(const float* in, size_t count, std::vector<float>& out) {
+    if (count == 0) return;
+    inputCount_ += count;
+
+    if (isPassthrough()) {
+        out.insert(out.end(), in, in + count);
+        outputCount_ += count;
+        return;
+    }
+
+    history_.insert(history_.end(), in, in + count);
+    run(out, UINT64_MAX);
+}
+
+void Resampler::flush(std::vector<float>& out) {
+    if (isPassthrough()) return;
+
+    // Zero padding lets the last outputs see the whole filter
+    history_.insert(history_.end(), static_cast<size_t>(tapsPerPhase_), 0.0f);
+    run(out, outputLength(inputCount_));
+}
+
+void Resampler::run(std::vector<float>& out, uint64_t limit) {
+    const uint64_t historyEnd = historyStart_ + history_.size();
+    const size_t taps = static_cast<size_t>(tapsPerPhase_);
+
+    while (outputCount_ < limit) {
+        const uint64_t n = nextPosition_ / upFactor_;
+        if (n >= historyEnd) break;
+        const size_t phase = static_cast<size_t>(nextPosition_ % upFactor_);
+
+        // Window covers prefixed input [n - T + 1, n]
+        const float* window = history_.data() + (n + 1 - taps - historyStart_);
+        out.push_back(SampleConvert::dotProduct(coeffs_.data() + phase * taps, window, taps));
+
+        nextPosition_ += downFactor_;
+        outputCount_++;
+    }
+
+    // Drop history the next output no longer needs
+    const uint64_t firstNeeded = nextPosition_ / upFactor_ + 1 - taps;
+    if (firstNeeded > historyStart_) {
+        const size_t drop = static_cast<size_t>(std::min<uint64_t>(firstNeeded - historyStart_, history_.size()));
+        history_.erase(history_.begin(), history_.begin() + drop);
+        historyStart_ += drop;
+    }
+}
+
+bool Resampler::resample(const float* in, size_t count, int inputRate, int outputRate, std::vector<float>& out) {
+    Resampler resampler;
+    if (!resampler.configure(inputRate, outputRate)) return false;
+    out.reserve(out.size() + static_cast<size_t>(resampler.outputLength(count)));
+    resampler.process(in, count, out);
+    resampler.flush(out);
+    return true;
+}
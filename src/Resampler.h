@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Streaming polyphase FIR resampler for mono float audio.
+// The rate ratio is reduced to L/M and a Kaiser-windowed sinc prototype is
+// split into L phases, so each output sample is one short dot product over
+// the input history. Output is delay-compensated: output sample k lines up
+// with input time k / outputRate, and flush() emits the filter tail.
+class Resampler {
+public:
+    Resampler() = default;
+
+    // Returns false if the ratio can't be handled (non-positive or too many phases)
+    bool configure(int inputRate, int outputRate);
+    void reset();
+
+    bool isPassthrough() const { return upFactor_ == 1 && downFactor_ == 1; }
+    int getInputRate() const { return inputRate_; }
+    int getOutputRate() const { return outputRate_; }
+
+    // Number of output samples produced for inputFrames input samples once flushed
+    uint64_t outputLength(uint64_t inputFrames) const;
+
+    // Feed input samples and append any output that is ready
+    void process(const float* in, size_t count, std::vector<float>& out);
+    // Signal end of input and append the remaining output
+    void flush(std::vector<float>& out);
+
+    // One-shot convenience wrapper
+    static bool resample(const float* in, size_t count, int inputRate, int outputRate, std::vector<float>& out);
+
+private:
+    void run(std::vector<float>& out, uint64_t limit);
+
+    int inputRate_ = 0;
+    int outputRate_ = 0;
+    int upFactor_ = 1;      // L
+    int downFactor_ = 1;    // M
+    int tapsPerPhase_ = 0;  // T, multiple of 8
+    std::vector<float> coeffs_; // L phases of T taps, reversed for a forward dot product
+
+    std::vector<float> history_; // Input, prefixed with T - 1 zeros
+    uint64_t historyStart_ = 0;  // Index of history_[0] in the prefixed input
+    uint64_t nextPosition_ = 0;  // Upsampled position of the next output
+    uint64_t inputCount_ = 0;
+    uint64_t outputCount_ = 0;
+};
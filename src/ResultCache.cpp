@@ -0,0 +1,281 @@
+#include "ResultCache.h"
+#include "Logger.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+    // XXH64 (public domain algorithm by Yann Collet); hashes several GB/s,
+    // so hashing a file costs far less than decoding it
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+    uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    uint64_t read64(const unsigned char* p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t read32(const unsigned char* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * kPrime2;
+        acc = rotl(acc, 31);
+        return acc * kPrime1;
+    }
+
+    uint64_t mergeRound(uint64_t acc, uint64_t value) {
+        acc ^= round(0, value);
+        return acc * kPrime1 + kPrime4;
+    }
+
+    // Streaming XXH64: whole 32-byte stripes go through update(), the tail through finish()
+    class Xxh64 {
+    public:
+        explicit Xxh64(uint64_t seed = 0)
+            : v1_(seed + kPrime1 + kPrime2), v2_(seed + kPrime2), v3_(seed), v4_(seed - kPrime1), seed_(seed) {}
+
+        void update(const unsigned char* data, size_t length) {
+            total_ += length;
+            if (bufferLength_ > 0) {
+                const size_t take = std::min(length, sizeof(buffer_) - bufferLength_);
+                memcpy(buffer_ + bufferLength_, data, take);
+                bufferLength_ += take;
+                data += take;
+                length -= take;
+                if (bufferLength_ < sizeof(buffer_)) return;
+                stripe(buffer_);
+                bufferLength_ = 0;
+            }
+            for (; length >= 32; data += 32, length -= 32) stripe(data);
+            memcpy(buffer_, data, length);
+            bufferLength_ = length;
+        }
+
+        uint64_t finish() const {
+            uint64_t h;
+            if (total_ >= 32) {
+                h = rotl(v1_, 1) + rotl(v2_, 7) + rotl(v3_, 12) + rotl(v4_, 18);
+                h = mergeRound(h, v1_);
+                h = mergeRound(h, v2_);
+                h = mergeRound(h, v3_);
+                h = mergeRound(h, v4_);
+            } else {
+                h = seed_ + kPrime5;
+            }
+            h += total_;
+            const unsigned char* p = buffer_;
+            size_t length = bufferLength_;
+            for (; length >= 8; p += 8, length -= 8) {
+                h ^= round(0, read64(p));
+                h = rotl(h, 27) * kPrime1 + kPrime4;
+            }
+            if (length >= 4) {
+                h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+                h = rotl(h, 23) * kPrime2 + kPrime3;
+                p += 4;
+                length -= 4;
+            }
+            for (; length > 0; ++p, --length) {
+                h ^= (*p) * kPrime5;
+                h = rotl(h, 11) * kPrime1;
+            }
+            h ^= h >> 33;
+            h *= kPrime2;
+            h ^= h >> 29;
+            h *= kPrime3;
+            h ^= h >> 32;
+            return h;
+        }
+
+    private:
+        void stripe(const unsigned char* p) {
+            v1_ = round(v1_, read64(p));
+            v2_ = round(v2_, read64(p + 8));
+            v3_ = round(v3_, read64(p + 16));
+            v4_ = round(v4_, read64(p + 24));
+        }
+
+        uint64_t v1_, v2_, v3_, v4_;
+        uint64_t seed_;
+        uint64_t total_ = 0;
+        unsigned char buffer_[32];
+        size_t bufferLength_ = 0;
+    };
+
+    uint64_t hashString(const std::string& text) {
+        Xxh64 hash;
+        hash.update(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+        return hash.finish();
+    }
+}
+
+ResultCache::ResultCache(const std::string& directory)
+    : directory_(directory) {
+    stats_.maxBytes = 256ull * 1024 * 1024;
+}
+
+bool ResultCache::hashFile(const std::string& path, uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    Xxh64 state;
+    std::vector<unsigned char> block(1 << 20);
+    while (file) {
+        file.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(block.size()));
+        const std::streamsize got = file.gcount();
+        if (got <= 0) break;
+        state.update(block.data(), static_cast<size_t>(got));
+    }
+    if (file.bad()) return false;
+    hash = state.finish();
+    return true;
+}
+
+uint64_t ResultCache::hashBytes(const void* data, size_t size) {
+    Xxh64 state;
+    state.update(static_cast<const unsigned char*>(data), size);
+    return state.finish();
+}
+
+std::string ResultCache::entryPath(uint64_t contentHash, const std::string& settings) const {
+    char name[48];
+    snprintf(name, sizeof(name), "%016llx-%08llx.json", static_cast<unsigned long long>(contentHash),
+             static_cast<unsigned long long>(hashString(settings) & 0xFFFFFFFFull));
+    return (fs::path(directory_) / name).string();
+}
+
+bool ResultCache::lookup(uint64_t contentHash, const std::string& settings, TranscriptResult& result) {
+    const std::string path = entryPath(contentHash, settings);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        try {
+            std::ifstream file(path);
+            json j;
+            file >> j;
+            if (j.value("settings", std::string()) == settings && j.contains("result")) {
+                result = TranscriptResult::fromJson(j["result"]);
+                // Mark as recently used for trimming
+                fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+                stats_.hits++;
+                return true;
+            }
+        } catch (const std::exception& e) {
+            LOG_WARNING("Result cache: unreadable entry " + path + ": " + e.what());
+            fs::remove(path, ec);
+        }
+    }
+    stats_.misses++;
+    return false;
+}
+
+void ResultCache::store(uint64_t contentHash, const std::string& settings, const TranscriptResult& result) {
+    if (!result.ok()) return;
+
+    // Runs on a transcription worker: a failed write only skips the entry
+    try {
+        json j;
+        j["settings"] = settings;
+        j["result"] = result.toJson();
+        // Like the history file, stray bytes in the text must not fail the write
+        const std::string data = j.dump(-1, ' ', false, json::error_handler_t::replace);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        scanLocked();
+        std::error_code ec;
+        fs::create_directories(directory_, ec);
+        const std::string path = entryPath(contentHash, settings);
+        const uint64_t previous = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+        {
+            // Write to a temporary file so a crash never leaves a truncated entry
+            const std::string temp = path + ".tmp";
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+                LOG_WARNING("Result cache: could not write " + temp);
+                return;
+            }
+            file.close();
+            fs::rename(temp, path, ec);
+            if (ec) {
+                LOG_WARNING("Result cache: could not store " + path + ": " + ec.message());
+                fs::remove(temp, ec);
+                return;
+            }
+        }
+        if (previous == 0) stats_.entries++;
+        stats_.bytes = stats_.bytes - std::min(stats_.bytes, previous) + data.size();
+        trimLocked();
+    } catch (const std::exception& e) {
+        LOG_WARNING(std::string("Result cache: entry not stored: ") + e.what());
+    }
+}
+
+void ResultCache::setMaxBytes(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.maxBytes = bytes;
+    if (scanned_) trimLocked();
+}
+
+ResultCache::Stats ResultCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ResultCache::scanLocked() {
+    if (scanned_) return;
+    scanned_ = true;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (entry.path().extension() != ".json") continue;
+        stats_.entries++;
+        stats_.bytes += entry.file_size(ec);
+    }
+}
+
+void ResultCache::trimLocked() {
+    if (stats_.bytes <= stats_.maxBytes) return;
+
+    struct File {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t size;
+    };
+    std::vector<File> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (entry.path().extension() != ".json") continue;
+        files.push_back({entry.path(), entry.last_write_time(ec), entry.file_size(ec)});
+    }
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.used < b.used; });
+
+    // Recount from disk while removing, in case files changed outside the app
+    stats_.entries = files.size();
+    stats_.bytes = 0;
+    for (const File& file : files) stats_.bytes += file.size;
+    for (const File& file : files) {
+        if (stats_.bytes <= stats_.maxBytes) break;
+        if (fs::remove(file.path, ec)) {
+            stats_.bytes -= std::min(stats_.bytes, file.size);
+            stats_.entries--;
+        }
+    }
+    LOG_INFO("Result cache: trimmed to " + std::to_string(stats_.entries) + " entries ("
+             + std::to_string(stats_.bytes >> 10) + " KB)");
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "TranscriptResult.h"
+#include <string>
+#include <mutex>
+#include <cstdint>
+
+// On-disk cache of finished transcriptions, keyed by content.
+// The key is a hash of the audio file's bytes plus a description of every
+// setting that changes the output (model, language, translate, diarization),
+// so re-queueing a file, or a copy of it under another name, returns the
+// stored result without decoding. The settings string is stored with the
+// entry and compared on lookup, so a hash collision can't return the wrong
+// transcript. Entries past the size limit are removed oldest-used first.
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t entries = 0;
+        uint64_t bytes = 0;
+        uint64_t maxBytes = 0;
+    };
+
+    explicit ResultCache(const std::string& directory = "cache/results");
+
+    // 64-bit hash of a file's contents; false if it can't be read
+    static bool hashFile(const std::string& path, uint64_t& hash);
+    // Same hash over a buffer in memory
+    static uint64_t hashBytes(const void* data, size_t size);
+
+    // settings: everything besides the audio that affects the result
+    bool lookup(uint64_t contentHash, const std::string& settings, TranscriptResult& result);
+    void store(uint64_t contentHash, const std::string& settings, const TranscriptResult& result);
+
+    void setMaxBytes(uint64_t bytes);
+    Stats getStats() const;
+
+private:
+    std::string entryPath(uint64_t contentHash, const std::string& settings) const;
+    void scanLocked();   // Caller holds mutex_
+    void trimLocked();   // Caller holds mutex_
+
+    std::string directory_;
+    mutable std::mutex mutex_;
+    bool scanned_ = false; // entries/bytes counted from the directory
+    Stats stats_;
+};
@@ -0,0 +1,236 @@
+#include "SampleConvert.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WHISPERGUI_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define WHISPERGUI_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define WHISPERGUI_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define WHISPERGUI_X86 0
+#endif
+
+namespace SampleConvert {
+
+namespace {
+    constexpr float kMonoScale = 1.0f / 32768.0f;
+    // (L + R) / 2 / 32768, applied to the integer sum so the result is exact
+    constexpr float kStereoScale = 1.0f / 65536.0f;
+
+    void s16ToFloatScalar(const int16_t* in, float* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<float>(in[i]) * kMonoScale;
+        }
+    }
+
+    void s16StereoToMonoScalar(const int16_t* in, float* out, size_t frames) {
+        for (size_t i = 0; i < frames; ++i) {
+            const int32_t sum = static_cast<int32_t>(in[2 * i]) + static_cast<int32_t>(in[2 * i + 1]);
+            out[i] = static_cast<float>(sum) * kStereoScale;
+        }
+    }
+
+    float dotProductScalar(const float* a, const float* b, size_t count) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+#if WHISPERGUI_X86
+    void s16ToFloatSSE2(const int16_t* in, float* out, size_t count) {
+        const __m128 scale = _mm_set1_ps(kMonoScale);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            // Sign-extend by placing each sample in the high half and shifting back down
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        s16ToFloatScalar(in + i, out + i, count - i);
+    }
+
+    void s16StereoToMonoSSE2(const int16_t* in, float* out, size_t frames) {
+        const __m128 scale = _mm_set1_ps(kStereoScale);
+        const __m128i ones = _mm_set1_epi16(1);
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8));
+            // madd with ones sums each L/R pair into a 32-bit lane
+            const __m128i sumA = _mm_madd_epi16(a, ones);
+            const __m128i sumB = _mm_madd_epi16(b, ones);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(sumA), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(sumB), scale));
+        }
+        s16StereoToMonoScalar(in + 2 * i, out + i, frames - i);
+    }
+
+    WHISPERGUI_TARGET_AVX2
+    void s16ToFloatAVX2(const int16_t* in, float* out, size_t count) {
+        const __m256 scale = _mm256_set1_ps(kMonoScale);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+            _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+        }
+        s16ToFloatScalar(in + i, out + i, count - i);
+    }
+
+    WHISPERGUI_TARGET_AVX2
+    void s16StereoToMonoAVX2(const int16_t* in, float* out, size_t frames) {
+        const __m256 scale = _mm256_set1_ps(kStereoScale);
+        const __m256i ones = _mm256_set1_epi16(1);
+        size_t i = 0;
+        for (; i + 16 <= frames; i += 16) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i + 16));
+            // madd works per 128-bit lane, which keeps the frames in order
+            const __m256i sumA = _mm256_madd_epi16(a, ones);
+            const __m256i sumB = _mm256_madd_epi16(b, ones);
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(sumA), scale));
+            _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(sumB), scale));
+        }
+        s16StereoToMonoScalar(in + 2 * i, out + i, frames - i);
+    }
+
+    float dotProductSSE2(const float* a, const float* b, size_t count) {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        __m128 acc = _mm_add_ps(acc0, acc1);
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        return _mm_cvtss_f32(acc) + dotProductScalar(a + i, b + i, count - i);
+    }
+
+    WHISPERGUI_TARGET_AVX2
+    float dotProductAVX2(const float* a, const float* b, size_t count) {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+        }
+        if (i + 8 <= count) {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            i += 8;
+        }
+        const __m256 acc = _mm256_add_ps(acc0, acc1);
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        return _mm_cvtss_f32(sum) + dotProductScalar(a + i, b + i, count - i);
+    }
+
+    bool cpuHasAVX2() {
+#if defined(_MSC_VER)
+        int info[4] = {0, 0, 0, 0};
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx) return false;
+        // The OS must save YMM registers on context switches
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+}
+
+Kernel bestKernel() {
+#if WHISPERGUI_X86
+    static const Kernel kernel = cpuHasAVX2() ? Kernel::AVX2 : Kernel::SSE2;
+    return kernel;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+const char* kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar: return "scalar";
+        case Kernel::SSE2: return "SSE2";
+        case Kernel::AVX2: return "AVX2";
+        default: return "unknown";
+    }
+}
+
+void s16ToFloat(const int16_t* in, float* out, size_t count) {
+    s16ToFloat(in, out, count, bestKernel());
+}
+
+void s16ToFloat(const int16_t* in, float* out, size_t count, Kernel kernel) {
+#if WHISPERGUI_X86
+    if (kernel == Kernel::AVX2 && bestKernel() == Kernel::AVX2) {
+        s16ToFloatAVX2(in, out, count);
+        return;
+    }
+    if (kernel != Kernel::Scalar) {
+        s16ToFloatSSE2(in, out, count);
+        return;
+    }
+#else
+    (void)kernel;
+#endif
+    s16ToFloatScalar(in, out, count);
+}
+
+void s16StereoToMonoFloat(const int16_t* in, float* out, size_t frames) {
+    s16StereoToMonoFloat(in, out, frames, bestKernel());
+}
+
+void s16StereoToMonoFloat(const int16_t* in, float* out, size_t frames, Kernel kernel) {
+#if WHISPERGUI_X86
+    if (kernel == Kernel::AVX2 && bestKernel() == Kernel::AVX2) {
+        s16StereoToMonoAVX2(in, out, frames);
+        return;
+    }
+    if (kernel != Kernel::Scalar) {
+        s16StereoToMonoSSE2(in, out, frames);
+        return;
+    }
+#else
+    (void)kernel;
+#endif
+    s16StereoToMonoScalar(in, out, frames);
+}
+
+float dotProduct(const float* a, const float* b, size_t count) {
+    return dotProduct(a, b, count, bestKernel());
+}
+
+float dotProduct(const float* a, const float* b, size_t count, Kernel kernel) {
+#if WHISPERGUI_X86
+    if (kernel == Kernel::AVX2 && bestKernel() == Kernel::AVX2) {
+        return dotProductAVX2(a, b, count);
+    }
+    if (kernel != Kernel::Scalar) {
+        return dotProductSSE2(a, b, count);
+    }
+#else
+    (void)kernel;
+#endif
+    return dotProductScalar(a, b, count);
+}
+
+} // namespace SampleConvert
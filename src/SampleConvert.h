@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Vectorised sample kernels used by the audio read path.
+// The best kernel for the running CPU (AVX2, SSE2 or scalar) is picked once
+// at first use; the explicit variants exist for benchmarking and testing.
+namespace SampleConvert {
+
+enum class Kernel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Kernel selected for this CPU
+Kernel bestKernel();
+const char* kernelName(Kernel kernel);
+
+// int16 mono -> float in [-1, 1)
+void s16ToFloat(const int16_t* in, float* out, size_t count);
+void s16ToFloat(const int16_t* in, float* out, size_t count, Kernel kernel);
+
+// Interleaved int16 stereo -> mono float, (L + R) / 2
+void s16StereoToMonoFloat(const int16_t* in, float* out, size_t frames);
+void s16StereoToMonoFloat(const int16_t* in, float* out, size_t frames, Kernel kernel);
+
+// Sum of a[i] * b[i]; the resampler's inner loop
+float dotProduct(const float* a, const float* b, size_t count);
+float dotProduct(const float* a, const float* b, size_t count, Kernel kernel);
+
+} // namespace SampleConvert
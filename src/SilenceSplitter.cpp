@@ -0,0 +1,74 @@
+#include "SilenceSplitter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SilenceSplitter {
+
+std::vector<Chunk> split(const float* samples, size_t numSamples, int sampleRate, const Options& options) {
+    std::vector<Chunk> chunks;
+    if (numSamples == 0 || sampleRate <= 0) return chunks;
+
+    const size_t minLength = std::max<size_t>(1, static_cast<size_t>(options.minSeconds * sampleRate));
+    const size_t maxLength = std::max(minLength, static_cast<size_t>(options.maxSeconds * sampleRate));
+    const size_t target = std::clamp(static_cast<size_t>(options.targetSeconds * sampleRate), minLength, maxLength);
+
+    if (numSamples <= maxLength) {
+        chunks.push_back({0, numSamples});
+        return chunks;
+    }
+
+    // Energy per 20 ms frame, as a prefix sum so any window average is O(1)
+    const size_t frame = std::max(1, sampleRate / 50);
+    const size_t numFrames = (numSamples + frame - 1) / frame;
+    std::vector<double> prefix(numFrames + 1, 0.0);
+    for (size_t f = 0; f < numFrames; ++f) {
+        const size_t begin = f * frame;
+        const size_t end = std::min(numSamples, begin + frame);
+        double energy = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            energy += static_cast<double>(samples[i]) * samples[i];
+        }
+        prefix[f + 1] = prefix[f] + energy / static_cast<double>(end - begin);
+    }
+    // 300 ms around a frame: long enough to skip the gaps between syllables
+    const size_t halfWindow = 7;
+    auto smoothedEnergy = [&](size_t f) {
+        const size_t begin = f > halfWindow ? f - halfWindow : 0;
+        const size_t end = std::min(numFrames, f + halfWindow + 1);
+        return (prefix[end] - prefix[begin]) / static_cast<double>(end - begin);
+    };
+
+    size_t start = 0;
+    while (numSamples - start > maxLength) {
+        size_t lo = start + minLength;
+        size_t hi = start + maxLength;
+        // Leave at least minLength for the final chunk
+        if (numSamples - minLength >= lo) {
+            hi = std::min(hi, numSamples - minLength);
+        }
+
+        size_t cut = start + (numSamples - start) / 2;
+        if (hi >= lo) {
+            // Quietest frame in the window, mildly biased toward the target length
+            const size_t preferred = start + target;
+            double best = -1.0;
+            for (size_t f = lo / frame; f <= hi / frame && f < numFrames; ++f) {
+                const size_t position = f * frame + frame / 2;
+                if (position < lo || position > hi) continue;
+                const double distance = std::abs(static_cast<double>(position) - static_cast<double>(preferred));
+                const double score = (smoothedEnergy(f) + 1e-12) * (1.0 + distance / static_cast<double>(maxLength));
+                if (best < 0.0 || score < best) {
+                    best = score;
+                    cut = position;
+                }
+            }
+        }
+
+        chunks.push_back({start, cut});
+        start = cut;
+    }
+    chunks.push_back({start, numSamples});
+    return chunks;
+}
+
+} // namespace SilenceSplitter
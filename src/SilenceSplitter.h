@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Cuts long mono recordings into chunks that can be transcribed independently.
+// Each cut is placed at the quietest stretch (lowest short-term energy) inside
+// the allowed length window, so chunk edges normally fall between words.
+namespace SilenceSplitter {
+
+struct Chunk {
+    size_t start; // First sample
+    size_t end;   // One past the last sample
+};
+
+struct Options {
+    float targetSeconds = 60.0f; // Preferred chunk length
+    float minSeconds = 30.0f;    // Shortest chunk (except a file shorter than this)
+    float maxSeconds = 120.0f;   // Longest chunk
+};
+
+// Chunks cover [0, numSamples) without gaps or overlap, in order
+std::vector<Chunk> split(const float* samples, size_t numSamples, int sampleRate, const Options& options);
+
+} // namespace SilenceSplitter
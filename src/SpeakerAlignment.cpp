@@ -0,0 +1,172 @@
+#include "SpeakerAlignment.h"
+#include <algorithm>
+
+namespace SpeakerAlignment {
+
+namespace {
+    // Something to label: a word, or a segment that has no words
+    struct Span {
+        float start;
+        float end;
+        size_t index;
+        bool isWord;
+    };
+
+    Span makeSpan(int64_t t0, int64_t t1, size_t index, bool isWord) {
+        const float start = static_cast<float>(t0) / 100.0f;
+        return {start, std::max(start, static_cast<float>(t1) / 100.0f), index, isWord};
+    }
+}
+
+std::vector<SpeakerSegment> turnsFrom(const TranscriptResult& result) {
+    std::vector<SpeakerSegment> turns;
+    auto extend = [&turns](int64_t t0, int64_t t1, int speaker) {
+        if (speaker < 0) return;
+        const float start = static_cast<float>(t0) / 100.0f;
+        const float end = std::max(start, static_cast<float>(t1) / 100.0f);
+        if (!turns.empty() && turns.back().speaker == speaker) {
+            turns.back().end = std::max(turns.back().end, end);
+        } else {
+            turns.push_back({start, end, speaker});
+        }
+    };
+    for (size_t i = 0; i < result.segmentCount(); ++i) {
+        const TranscriptResult::Segment& segment = result.segment(i);
+        if (segment.wordCount == 0) {
+            extend(segment.t0, segment.t1, segment.speaker);
+            continue;
+        }
+        for (uint32_t k = 0; k < segment.wordCount; ++k) {
+            const TranscriptResult::Word& word = result.word(segment.firstWord + k);
+            extend(word.t0, word.t1, word.speaker);
+        }
+    }
+    return turns;
+}
+
+void assignSpeakers(TranscriptResult& result, const std::vector<SpeakerSegment>& turns) {
+    if (turns.empty() || result.empty()) return;
+
+    // Turns sorted by start
+    std::vector<const SpeakerSegment*> sorted;
+    sorted.reserve(turns.size());
+    int maxSpeaker = 0;
+    for (const SpeakerSegment& turn : turns) {
+        if (turn.speaker < 0 || turn.end <= turn.start) continue;
+        sorted.push_back(&turn);
+        maxSpeaker = std::max(maxSpeaker, turn.speaker);
+    }
+    if (sorted.empty()) return;
+    std::sort(sorted.begin(), sorted.end(), [](const SpeakerSegment* a, const SpeakerSegment* b) {
+        return a->start < b->start;
+    });
+
+    // Words sorted by start; whisper emits them nearly in order, so the sort is cheap
+    std::vector<Span> spans;
+    spans.reserve(result.wordCount() + result.segmentCount());
+    for (size_t i = 0; i < result.segmentCount(); ++i) {
+        const TranscriptResult::Segment& segment = result.segment(i);
+        if (segment.wordCount == 0) {
+            spans.push_back(makeSpan(segment.t0, segment.t1, i, false));
+            continue;
+        }
+        for (uint32_t k = 0; k < segment.wordCount; ++k) {
+            const TranscriptResult::Word& word = result.word(segment.firstWord + k);
+            spans.push_back(makeSpan(word.t0, word.t1, segment.firstWord + k, true));
+        }
+    }
+    std::stable_sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) {
+        return a.start < b.start;
+    });
+
+    // Turns that may still overlap upcoming spans. Diarization turns rarely
+    // overlap each other, so this stays tiny.
+    std::vector<const SpeakerSegment*> active;
+    const SpeakerSegment* lastEnded = nullptr; // Latest-ending turn already behind us
+    std::vector<float> overlapBySpeaker(static_cast<size_t>(maxSpeaker) + 1, 0.0f);
+    size_t next = 0;
+
+    for (const Span& span : spans) {
+        const float start = span.start;
+        const float end = span.end;
+
+        // Admit turns that begin before this span ends
+        while (next < sorted.size() && sorted[next]->start < end) {
+            active.push_back(sorted[next]);
+            next++;
+        }
+        // Retire turns that ended before this span starts
+        for (size_t i = 0; i < active.size();) {
+            if (active[i]->end <= start) {
+                if (!lastEnded || active[i]->end > lastEnded->end) {
+                    lastEnded = active[i];
+                }
+                active[i] = active.back();
+                active.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        // Overlap-weighted vote among the active turns
+        int bestSpeaker = -1;
+        float bestOverlap = 0.0f;
+        for (const SpeakerSegment* turn : active) {
+            // Zero-length spans still count as touching the turn they sit in
+            const float overlap = std::min(end, turn->end) - std::max(start, turn->start);
+            if (overlap < 0.0f || (overlap == 0.0f && end > start)) continue;
+            float& total = overlapBySpeaker[static_cast<size_t>(turn->speaker)];
+            total += std::max(overlap, 1e-6f);
+            if (total > bestOverlap) {
+                bestOverlap = total;
+                bestSpeaker = turn->speaker;
+            }
+        }
+        for (const SpeakerSegment* turn : active) {
+            overlapBySpeaker[static_cast<size_t>(turn->speaker)] = 0.0f;
+        }
+
+        // In a gap: take whichever neighbouring turn is closer
+        if (bestSpeaker < 0) {
+            const SpeakerSegment* following = next < sorted.size() ? sorted[next] : nullptr;
+            const float before = lastEnded ? start - lastEnded->end : -1.0f;
+            const float after = following ? following->start - end : -1.0f;
+            if (lastEnded && (!following || before <= after)) {
+                bestSpeaker = lastEnded->speaker;
+            } else if (following) {
+                bestSpeaker = following->speaker;
+            }
+        }
+
+        if (span.isWord) {
+            result.setWordSpeaker(span.index, bestSpeaker);
+        } else {
+            result.setSpeaker(span.index, bestSpeaker);
+        }
+    }
+
+    // Segments with words: the speaker holding most of the spoken time
+    for (size_t i = 0; i < result.segmentCount(); ++i) {
+        const TranscriptResult::Segment& segment = result.segment(i);
+        if (segment.wordCount == 0) continue;
+        int bestSpeaker = -1;
+        float bestTime = 0.0f;
+        for (uint32_t k = 0; k < segment.wordCount; ++k) {
+            const TranscriptResult::Word& word = result.word(segment.firstWord + k);
+            if (word.speaker < 0) continue;
+            float& total = overlapBySpeaker[static_cast<size_t>(word.speaker)];
+            total += std::max(static_cast<float>(word.t1 - word.t0), 1e-3f);
+            if (total > bestTime) {
+                bestTime = total;
+                bestSpeaker = word.speaker;
+            }
+        }
+        for (uint32_t k = 0; k < segment.wordCount; ++k) {
+            const int speaker = result.word(segment.firstWord + k).speaker;
+            if (speaker >= 0) overlapBySpeaker[static_cast<size_t>(speaker)] = 0.0f;
+        }
+        result.setSpeaker(i, bestSpeaker);
+    }
+}
+
+} // namespace SpeakerAlignment
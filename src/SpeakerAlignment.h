@@ -0,0 +1,22 @@
+#pragma once
+#include "SpeakerDiarizer.h"
+#include "TranscriptResult.h"
+#include <vector>
+
+// Attaches diarization speakers to transcript words and segments.
+// Words (and any segment without word timings) are swept once in time order
+// against the turns, so the cost is linear in words + speaker turns (plus the
+// sorts). Each word gets the speaker with the most overlapping time; a word
+// that falls in a gap between turns takes the nearest turn. A segment's own
+// speaker is the one holding most of its words' time, and the sinks split
+// the segment wherever its words change speaker.
+namespace SpeakerAlignment {
+
+void assignSpeakers(TranscriptResult& result, const std::vector<SpeakerSegment>& turns);
+
+// The turns behind an already labelled result: runs of consecutive words (or
+// wordless segments) with one speaker. Lets another pass over the same audio
+// be labelled without diarizing it again.
+std::vector<SpeakerSegment> turnsFrom(const TranscriptResult& result);
+
+} // namespace SpeakerAlignment
@@ -4,6 +4,8 @@
 #include <filesystem>
 #include <cmath>
 #include <cstring>
+#include <cstdio>
+#include <algorithm>
 
 #if WHISPERGUI_HAS_SHERPA_ONNX
 #include "sherpa-onnx/c-api/c-api.h"
@@ -54,8 +56,14 @@ bool SpeakerDiarizer::initialize(const std::string& segmentationModel,
                                   const std::string& embeddingModel,
                                   int numSpeakers) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    numSpeakers_ = numSpeakers;
+    {
+        std::lock_guard<std::mutex> configLock(configMutex_);
+        numSpeakers_ = numSpeakers;
+#if WHISPERGUI_HAS_SHERPA_ONNX
+        segmentationModel_ = segmentationModel;
+        embeddingModel_ = embeddingModel;
+#endif
+    }
     
     LOG_INFO("Initializing speaker diarizer");
     LOG_INFO("  Segmentation model: " + segmentationModel);
@@ -80,24 +88,51 @@ bool SpeakerDiarizer::initialize(const std::string& segmentationModel,
         return false;
     }
     
+    if (!createPipeline()) {
+        return false;
+    }
+    
+    LOG_INFO("Speaker diarization initialized successfully (sherpa-onnx)");
+    std::cout << "Speaker diarization initialized (sherpa-onnx)" << std::endl;
+    std::cout << "  Segmentation model: " << segmentationModel << std::endl;
+    std::cout << "  Embedding model: " << embeddingModel << std::endl;
+    
+    return true;
+#else
+    // Fallback mode - no models needed, just mark as initialized
+    LOG_INFO("Speaker diarization initialized (heuristic fallback)");
+    std::cout << "Speaker diarization initialized (heuristic fallback)" << std::endl;
+    std::cout << "  Note: Build with -DWHISPERGUI_USE_SHERPA_ONNX=ON for neural diarization" << std::endl;
+    initialized_ = true;
+    return true;
+#endif
+}
+
+#if WHISPERGUI_HAS_SHERPA_ONNX
+// Builds the sherpa-onnx pipeline from the stored settings. Caller holds mutex_.
+bool SpeakerDiarizer::createPipeline() {
     // Configure the diarization pipeline
     SherpaOnnxOfflineSpeakerDiarizationConfig config;
     memset(&config, 0, sizeof(config));
     
     // Segmentation model config (pyannote-based)
-    config.segmentation.pyannote.model = segmentationModel.c_str();
-    config.segmentation.num_threads = 2;
+    {
+        std::lock_guard<std::mutex> configLock(configMutex_);
+        pipelineThreads_ = numThreads_;
+    }
+    config.segmentation.pyannote.model = segmentationModel_.c_str();
+    config.segmentation.num_threads = pipelineThreads_;
     config.segmentation.debug = 0;
     config.segmentation.provider = "cpu";
     
     // Speaker embedding extractor config
-    config.embedding.model = embeddingModel.c_str();
-    config.embedding.num_threads = 2;
+    config.embedding.model = embeddingModel_.c_str();
+    config.embedding.num_threads = pipelineThreads_;
     config.embedding.debug = 0;
     config.embedding.provider = "cpu";
     
     // Clustering config
-    config.clustering.num_clusters = numSpeakers;  // -1 for auto
+    config.clustering.num_clusters = numSpeakers_;  // -1 for auto
     config.clustering.threshold = clusteringThreshold_;
     
     // Segment filtering
@@ -112,26 +147,14 @@ bool SpeakerDiarizer::initialize(const std::string& segmentationModel,
         std::cerr << "Failed to create speaker diarization pipeline" << std::endl;
         return false;
     }
-    
-    LOG_INFO("Speaker diarization initialized successfully (sherpa-onnx)");
-    std::cout << "Speaker diarization initialized (sherpa-onnx)" << std::endl;
-    std::cout << "  Segmentation model: " << segmentationModel << std::endl;
-    std::cout << "  Embedding model: " << embeddingModel << std::endl;
-    
     return true;
-#else
-    // Fallback mode - no models needed, just mark as initialized
-    LOG_INFO("Speaker diarization initialized (heuristic fallback)");
-    std::cout << "Speaker diarization initialized (heuristic fallback)" << std::endl;
-    std::cout << "  Note: Build with -DWHISPERGUI_USE_SHERPA_ONNX=ON for neural diarization" << std::endl;
-    initialized_ = true;
-    return true;
-#endif
 }
+#endif
 
 std::vector<SpeakerSegment> SpeakerDiarizer::process(const float* samples, 
                                                        int numSamples, 
-                                                       int sampleRate) {
+                                                       int sampleRate,
+                                                       const ProgressCallback& progress) {
 #if WHISPERGUI_HAS_SHERPA_ONNX
     std::vector<SpeakerSegment> segments;
     
@@ -141,10 +164,29 @@ std::vector<SpeakerSegment> SpeakerDiarizer::process(const float* samples,
         std::cerr << "Speaker diarizer not initialized" << std::endl;
         return segments;
     }
+
+    // Thread counts are fixed when the ONNX sessions are created, so a changed
+    // setting rebuilds the pipeline here, where no run can be using it
+    if (getNumThreads() != pipelineThreads_) {
+        SherpaOnnxDestroyOfflineSpeakerDiarization(diarizer_);
+        diarizer_ = nullptr;
+        if (!createPipeline()) {
+            return segments;
+        }
+        LOG_INFO("Speaker diarization now uses " + std::to_string(pipelineThreads_) + " threads");
+    }
     
-    // Process the audio
-    const SherpaOnnxOfflineSpeakerDiarizationResult* result = 
-        SherpaOnnxOfflineSpeakerDiarizationProcess(diarizer_, samples, numSamples);
+    // Process the audio; a non-zero return from the callback stops sherpa early
+    const SherpaOnnxOfflineSpeakerDiarizationResult* result = nullptr;
+    if (progress) {
+        auto callback = [](int32_t processed, int32_t total, void* arg) -> int32_t {
+            return (*static_cast<const ProgressCallback*>(arg))(processed, total) ? 0 : 1;
+        };
+        result = SherpaOnnxOfflineSpeakerDiarizationProcessWithCallback(
+            diarizer_, samples, numSamples, callback, const_cast<ProgressCallback*>(&progress));
+    } else {
+        result = SherpaOnnxOfflineSpeakerDiarizationProcess(diarizer_, samples, numSamples);
+    }
     
     if (!result) {
         std::cerr << "Speaker diarization processing failed" << std::endl;
@@ -185,6 +227,7 @@ std::vector<SpeakerSegment> SpeakerDiarizer::process(const float* samples,
     
     return segments;
 #else
+    (void)progress;
     return processWithHeuristics(samples, numSamples, sampleRate);
 #endif
 }
@@ -309,7 +352,10 @@ int SpeakerDiarizer::getSampleRate() const {
 
 void SpeakerDiarizer::setNumSpeakers(int numSpeakers) {
     std::lock_guard<std::mutex> lock(mutex_);
-    numSpeakers_ = numSpeakers;
+    {
+        std::lock_guard<std::mutex> configLock(configMutex_);
+        numSpeakers_ = numSpeakers;
+    }
     
 #if WHISPERGUI_HAS_SHERPA_ONNX
     if (diarizer_) {
@@ -322,9 +368,45 @@ void SpeakerDiarizer::setNumSpeakers(int numSpeakers) {
 #endif
 }
 
+std::string SpeakerDiarizer::getSegmentationModel() const {
+#if WHISPERGUI_HAS_SHERPA_ONNX
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return segmentationModel_;
+#else
+    return "";
+#endif
+}
+
+std::string SpeakerDiarizer::getEmbeddingModel() const {
+#if WHISPERGUI_HAS_SHERPA_ONNX
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return embeddingModel_;
+#else
+    return "";
+#endif
+}
+
+void SpeakerDiarizer::setNumThreads(int numThreads) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    numThreads_ = std::max(1, numThreads);
+}
+
+int SpeakerDiarizer::getNumSpeakers() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return numSpeakers_;
+}
+
+int SpeakerDiarizer::getNumThreads() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return numThreads_;
+}
+
 void SpeakerDiarizer::setClusteringThreshold(float threshold) {
     std::lock_guard<std::mutex> lock(mutex_);
-    clusteringThreshold_ = threshold;
+    {
+        std::lock_guard<std::mutex> configLock(configMutex_);
+        clusteringThreshold_ = threshold;
+    }
     
 #if WHISPERGUI_HAS_SHERPA_ONNX
     if (diarizer_) {
@@ -337,6 +419,22 @@ void SpeakerDiarizer::setClusteringThreshold(float threshold) {
 #endif
 }
 
+std::string SpeakerDiarizer::describe() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+#if WHISPERGUI_HAS_SHERPA_ONNX
+    auto identity = [](const std::string& path) {
+        std::error_code ec;
+        const uintmax_t size = fs::file_size(path, ec);
+        return fs::path(path).filename().string() + ":" + std::to_string(ec ? 0 : size);
+    };
+    char threshold[16];
+    snprintf(threshold, sizeof(threshold), "%.3f", clusteringThreshold_);
+    return "neural," + identity(segmentationModel_) + "," + identity(embeddingModel_) + ",threshold=" + threshold;
+#else
+    return "heuristic";
+#endif
+}
+
 std::string SpeakerDiarizer::getSegmentationModelUrl() {
     // sherpa-onnx pyannote segmentation model
     return "https://github.com/k2-fsa/sherpa-onnx/releases/download/speaker-segmentation-models/sherpa-onnx-pyannote-segmentation-3-0.tar.bz2";
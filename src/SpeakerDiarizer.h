@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <functional>
 
 #if WHISPERGUI_HAS_SHERPA_ONNX
 // Forward declarations for sherpa-onnx types
@@ -39,15 +40,28 @@ public:
     // samples: audio samples (normalized to [-1, 1])
     // sampleRate: sample rate of the audio (should be 16000)
     // numSamples: number of samples
-    std::vector<SpeakerSegment> process(const float* samples, int numSamples, int sampleRate = 16000);
+    // progress: called with (processed, total) chunks; returning false stops early
+    using ProgressCallback = std::function<bool(int processed, int total)>;
+    std::vector<SpeakerSegment> process(const float* samples, int numSamples, int sampleRate = 16000,
+                                        const ProgressCallback& progress = nullptr);
 
     // Get the expected sample rate
     int getSampleRate() const;
 
     // Set clustering parameters
     void setNumSpeakers(int numSpeakers);
+    int getNumSpeakers() const;
     void setClusteringThreshold(float threshold);
 
+    // Model files given to initialize() (empty in heuristic mode)
+    std::string getSegmentationModel() const;
+    std::string getEmbeddingModel() const;
+
+    // CPU threads for the segmentation and embedding models. Never waits on a
+    // running process(); the pipeline is rebuilt with the new count when the next run starts.
+    void setNumThreads(int numThreads);
+    int getNumThreads() const;
+
     // Get model paths for download URLs
     static std::string getSegmentationModelUrl();
     static std::string getEmbeddingModelUrl();
@@ -56,13 +70,29 @@ public:
     // Check if using sherpa-onnx or fallback
     static bool isUsingNeuralDiarization();
 
+    // What produces the speaker labels: mode, model files (name and size) and
+    // clustering. Results cached under one description don't apply to another.
+    std::string describe() const;
+
 private:
 #if WHISPERGUI_HAS_SHERPA_ONNX
     const SherpaOnnxOfflineSpeakerDiarization* diarizer_ = nullptr;
+    int pipelineThreads_ = 0; // Thread count diarizer_ was built with
+    bool createPipeline();
 #endif
-    std::mutex mutex_;
+    // mutex_ serializes the pipeline (process() holds it for the whole run);
+    // configMutex_ guards the settings below so getters and describe() never
+    // wait on a running job. Writers hold both (mutex_ first); readers either.
+    // numThreads_ alone is written under configMutex_ only.
+    mutable std::mutex mutex_;
+    mutable std::mutex configMutex_;
     int numSpeakers_ = -1;
+    int numThreads_ = 2;
     float clusteringThreshold_ = 0.5f;
+#if WHISPERGUI_HAS_SHERPA_ONNX
+    std::string segmentationModel_;
+    std::string embeddingModel_;
+#endif
     bool initialized_ = false;
     
     // Fallback heuristic-based detection state
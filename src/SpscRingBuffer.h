@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// Fixed-size single-producer/single-consumer queue of trivially copyable
+// items. Storage is allocated once up front and push()/pop() never block or
+// allocate, so the producer can be a real-time thread (the SDL audio
+// callback). Only one thread may push and one pop at a time; a consumer
+// shared between threads must be serialized by the caller.
+template <typename T>
+class SpscRingBuffer {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRingBuffer(size_t capacity = 0) { reset(capacity); }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Reallocates and empties the buffer; neither side may be running
+    void reset(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        buffer_.assign(capacity > 0 ? size : 0, T());
+        mask_ = buffer_.empty() ? 0 : buffer_.size() - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return buffer_.size(); }
+
+    // Producer: copies up to count items, returns how many fit
+    size_t push(const T* items, size_t count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t n = std::min(count, buffer_.size() - (head - tail));
+        const size_t first = std::min(n, buffer_.size() - (head & mask_));
+        std::copy(items, items + first, buffer_.begin() + static_cast<std::ptrdiff_t>(head & mask_));
+        std::copy(items + first, items + n, buffer_.begin());
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer: moves up to maxCount items into out, returns how many
+    size_t pop(T* out, size_t maxCount) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t n = std::min(maxCount, head - tail);
+        const size_t first = std::min(n, buffer_.size() - (tail & mask_));
+        const auto start = buffer_.begin() + static_cast<std::ptrdiff_t>(tail & mask_);
+        std::copy(start, start + static_cast<std::ptrdiff_t>(first), out);
+        std::copy(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(n - first), out + first);
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Items waiting; exact for the consumer, a lower bound for anyone else
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+    // Free-running counters; only their difference matters, so wrap-around is harmless
+    alignas(64) std::atomic<size_t> head_{0}; // Written by the producer
+    alignas(64) std::atomic<size_t> tail_{0}; // Written by the consumer
+};
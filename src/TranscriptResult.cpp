@@ -0,0 +1,418 @@
+#include "TranscriptResult.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+
+using json = nlohmann::json;
+
+namespace {
+    // HH:MM:SS<sep>mmm for subtitle formats
+    std::string formatClock(int64_t cs, char separator) {
+        if (cs < 0) cs = 0;
+        const int64_t ms = cs * 10;
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d%c%03d",
+                 static_cast<int>(ms / 3600000), static_cast<int>(ms / 60000 % 60),
+                 static_cast<int>(ms / 1000 % 60), separator, static_cast<int>(ms % 1000));
+        return buffer;
+    }
+
+    // Scripts written without spaces between words
+    bool isUnspacedScript(uint32_t cp) {
+        return (cp >= 0x0E00 && cp <= 0x0EFF)     // Thai, Lao
+            || (cp >= 0x1000 && cp <= 0x109F)     // Myanmar
+            || (cp >= 0x1780 && cp <= 0x17FF)     // Khmer
+            || (cp >= 0x2E80 && cp <= 0x9FFF)     // CJK radicals and punctuation, kana, CJK ideographs
+            || (cp >= 0xF900 && cp <= 0xFAFF)     // CJK compatibility ideographs
+            || (cp >= 0xFF00 && cp <= 0xFFEF)     // Full-width forms
+            || (cp >= 0x20000 && cp <= 0x3FFFF);  // CJK extensions
+    }
+
+    bool isValidUtf8(std::string_view text) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+        size_t i = 0;
+        while (i < text.size()) {
+            const unsigned char lead = bytes[i];
+            size_t length = 0;
+            if (lead < 0x80) length = 1;
+            else if (lead >= 0xC2 && lead <= 0xDF) length = 2;
+            else if (lead >= 0xE0 && lead <= 0xEF) length = 3;
+            else if (lead >= 0xF0 && lead <= 0xF4) length = 4;
+            else return false;
+            if (i + length > text.size()) return false;
+            for (size_t k = 1; k < length; ++k) {
+                if ((bytes[i + k] & 0xC0u) != 0x80u) return false;
+            }
+            // Overlong forms, surrogates and code points past U+10FFFF
+            if ((lead == 0xE0 && bytes[i + 1] < 0xA0) || (lead == 0xED && bytes[i + 1] > 0x9F)
+                || (lead == 0xF0 && bytes[i + 1] < 0x90) || (lead == 0xF4 && bytes[i + 1] > 0x8F)) {
+                return false;
+            }
+            i += length;
+        }
+        return true;
+    }
+
+    // Whisper tokens can end inside a multi-byte character, which a JSON string
+    // can't hold; such text is stored as an array of byte values instead
+    json textToJson(std::string_view text) {
+        if (isValidUtf8(text)) return std::string(text);
+        json bytes = json::array();
+        for (char c : text) bytes.push_back(static_cast<unsigned char>(c));
+        return bytes;
+    }
+
+    std::string textFromJson(const json& j) {
+        if (j.is_string()) return j.get<std::string>();
+        std::string text;
+        if (j.is_array()) {
+            for (const auto& byte : j) text.push_back(static_cast<char>(byte.get<int>()));
+        }
+        return text;
+    }
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\n')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\n')) text.remove_suffix(1);
+        return text;
+    }
+}
+
+TranscriptResult TranscriptResult::failure(const std::string& message) {
+    TranscriptResult result;
+    result.error_ = message;
+    return result;
+}
+
+TranscriptResult TranscriptResult::fromText(const std::string& text, int64_t durationCs) {
+    TranscriptResult result;
+    result.addSegment(0, durationCs, text);
+    result.durationCs_ = durationCs;
+    return result;
+}
+
+uint32_t TranscriptResult::storeText(std::string_view text) {
+    const uint32_t offset = static_cast<uint32_t>(textPool_.size());
+    textPool_.append(text.data(), text.size());
+    return offset;
+}
+
+void TranscriptResult::addSegment(int64_t t0, int64_t t1, std::string_view text, int speaker) {
+    Segment segment;
+    segment.t0 = t0;
+    segment.t1 = t1;
+    segment.speaker = speaker;
+    segment.textOffset = storeText(text);
+    segment.textLength = static_cast<uint32_t>(text.size());
+    segment.firstToken = static_cast<uint32_t>(tokens_.size());
+    segment.firstWord = static_cast<uint32_t>(words_.size());
+    segments_.push_back(segment);
+}
+
+void TranscriptResult::addToken(int id, int64_t t0, int64_t t1, float p, std::string_view text) {
+    if (segments_.empty()) return;
+    Token token;
+    token.id = id;
+    token.t0 = t0;
+    token.t1 = t1;
+    token.p = p;
+    token.textOffset = storeText(text);
+    token.textLength = static_cast<uint32_t>(text.size());
+    tokens_.push_back(token);
+
+    // Extend the current word unless this token opens a new one
+    Segment& segment = segments_.back();
+    segment.tokenCount++;
+    if (segment.wordCount > 0 && !opensWord(text)) {
+        Word& word = words_.back();
+        word.t1 = std::max(word.t1, t1);
+        word.textLength = token.textOffset + token.textLength - word.textOffset;
+        return;
+    }
+    Word word;
+    word.t0 = t0;
+    word.t1 = t1;
+    word.textOffset = token.textOffset;
+    word.textLength = token.textLength;
+    words_.push_back(word);
+    segment.wordCount++;
+}
+
+bool TranscriptResult::opensWord(std::string_view tokenText) {
+    if (tokenText.empty()) return false;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(tokenText.data());
+    if (bytes[0] == ' ') return true;
+
+    // First code point. A token holding the tail of a character split across
+    // tokens starts with a continuation byte and extends the current word; one
+    // holding only its head is decoded as far as it goes.
+    size_t length = 0;
+    uint32_t cp = 0;
+    if ((bytes[0] & 0xE0u) == 0xC0u) {
+        length = 2;
+        cp = bytes[0] & 0x1Fu;
+    } else if ((bytes[0] & 0xF0u) == 0xE0u) {
+        length = 3;
+        cp = bytes[0] & 0x0Fu;
+    } else if ((bytes[0] & 0xF8u) == 0xF0u) {
+        length = 4;
+        cp = bytes[0] & 0x07u;
+    } else {
+        return false; // ASCII or a continuation byte
+    }
+    for (size_t i = 1; i < length; ++i) {
+        const unsigned char next = i < tokenText.size() ? bytes[i] : 0x80u;
+        if ((next & 0xC0u) != 0x80u) return false;
+        cp = (cp << 6) | (next & 0x3Fu);
+    }
+    return isUnspacedScript(cp);
+}
+
+void TranscriptResult::shiftTimes(int64_t offsetCs) {
+    for (Segment& segment : segments_) {
+        segment.t0 += offsetCs;
+        segment.t1 += offsetCs;
+    }
+    for (Token& token : tokens_) {
+        token.t0 += offsetCs;
+        token.t1 += offsetCs;
+    }
+    for (Word& word : words_) {
+        word.t0 += offsetCs;
+        word.t1 += offsetCs;
+    }
+}
+
+void TranscriptResult::mapTimes(const std::function<int64_t(int64_t)>& map) {
+    for (Segment& segment : segments_) {
+        segment.t0 = map(segment.t0);
+        segment.t1 = map(segment.t1);
+    }
+    for (Token& token : tokens_) {
+        token.t0 = map(token.t0);
+        token.t1 = map(token.t1);
+    }
+    for (Word& word : words_) {
+        word.t0 = map(word.t0);
+        word.t1 = map(word.t1);
+    }
+}
+
+void TranscriptResult::append(const TranscriptResult& other, int64_t offsetCs) {
+    const uint32_t textBase = static_cast<uint32_t>(textPool_.size());
+    const uint32_t tokenBase = static_cast<uint32_t>(tokens_.size());
+    const uint32_t wordBase = static_cast<uint32_t>(words_.size());
+    textPool_ += other.textPool_;
+
+    segments_.reserve(segments_.size() + other.segments_.size());
+    for (Segment segment : other.segments_) {
+        segment.t0 += offsetCs;
+        segment.t1 += offsetCs;
+        segment.textOffset += textBase;
+        segment.firstToken += tokenBase;
+        segment.firstWord += wordBase;
+        segments_.push_back(segment);
+    }
+    tokens_.reserve(tokens_.size() + other.tokens_.size());
+    for (Token token : other.tokens_) {
+        token.t0 += offsetCs;
+        token.t1 += offsetCs;
+        token.textOffset += textBase;
+        tokens_.push_back(token);
+    }
+    words_.reserve(words_.size() + other.words_.size());
+    for (Word word : other.words_) {
+        word.t0 += offsetCs;
+        word.t1 += offsetCs;
+        word.textOffset += textBase;
+        words_.push_back(word);
+    }
+    durationCs_ = std::max(durationCs_, offsetCs + other.durationCs_);
+}
+
+std::string_view TranscriptResult::segmentText(size_t i) const {
+    const Segment& segment = segments_[i];
+    return std::string_view(textPool_).substr(segment.textOffset, segment.textLength);
+}
+
+std::string_view TranscriptResult::tokenText(const Token& token) const {
+    return std::string_view(textPool_).substr(token.textOffset, token.textLength);
+}
+
+std::string_view TranscriptResult::wordText(const Word& word) const {
+    return std::string_view(textPool_).substr(word.textOffset, word.textLength);
+}
+
+template <typename Fn>
+void TranscriptResult::forEachSpeakerRun(size_t index, Fn&& fn) const {
+    const Segment& segment = segments_[index];
+    const Word* first = words_.data() + segment.firstWord;
+    const Word* last = first + segment.wordCount;
+
+    // Words without a speaker stay with the run they sit in
+    bool split = false;
+    int speaker = -1;
+    for (const Word* word = first; word != last && !split; ++word) {
+        if (word->speaker < 0) continue;
+        split = speaker >= 0 && word->speaker != speaker;
+        speaker = word->speaker;
+    }
+    if (!split) {
+        fn(SpeakerRun{segment.t0, segment.t1, segment.speaker, segmentText(index)});
+        return;
+    }
+
+    const std::string_view pool(textPool_);
+    const Word* runStart = first;
+    speaker = -1;
+    for (const Word* word = first; word != last; ++word) {
+        if (speaker < 0) speaker = word->speaker;
+        const Word* next = word + 1;
+        if (next != last && (speaker < 0 || next->speaker < 0 || next->speaker == speaker)) continue;
+
+        // Runs tile the segment: the first starts at its t0, the last ends at its t1
+        const int64_t t0 = runStart == first ? segment.t0 : runStart->t0;
+        const int64_t t1 = next == last ? segment.t1 : std::max(t0, word->t1);
+        fn(SpeakerRun{t0, t1, speaker,
+                      pool.substr(runStart->textOffset, word->textOffset + word->textLength - runStart->textOffset)});
+        runStart = next;
+        speaker = -1;
+    }
+}
+
+std::string TranscriptResult::toText(bool timestamps) const {
+    if (!ok()) return error_;
+
+    std::string result;
+    result.reserve(textPool_.size() + segments_.size() * 40);
+    int lastSpeaker = -1;
+
+    bool first = true;
+
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        forEachSpeakerRun(i, [&](const SpeakerRun& run) {
+            if (!first) result += "\n";
+
+            // Add speaker label if speaker changed
+            if (run.speaker >= 0 && run.speaker != lastSpeaker) {
+                if (!first) result += "\n";
+                result += "Speaker " + std::to_string(run.speaker + 1) + ": ";
+                lastSpeaker = run.speaker;
+            }
+            first = false;
+
+            if (timestamps) {
+                char timestamp[48];
+                snprintf(timestamp, sizeof(timestamp), "[%02d:%02d.%03d --> %02d:%02d.%03d] ",
+                         (int)(run.t0 / 100 / 60), (int)(run.t0 / 100 % 60), (int)(run.t0 % 100) * 10,
+                         (int)(run.t1 / 100 / 60), (int)(run.t1 / 100 % 60), (int)(run.t1 % 100) * 10);
+                result += timestamp;
+            }
+            result += run.text;
+        });
+    }
+
+    return result;
+}
+
+void TranscriptResult::appendSrt(std::string& out, int& cueIndex, int64_t offsetCs) const {
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        forEachSpeakerRun(i, [&](const SpeakerRun& run) {
+            const std::string_view text = trim(run.text);
+            if (text.empty()) return;
+
+            out += std::to_string(cueIndex++) + "\n";
+            out += formatClock(run.t0 + offsetCs, ',') + " --> " + formatClock(run.t1 + offsetCs, ',') + "\n";
+            if (run.speaker >= 0) {
+                out += "Speaker " + std::to_string(run.speaker + 1) + ": ";
+            }
+            out += text;
+            out += "\n\n";
+        });
+    }
+}
+
+void TranscriptResult::appendVtt(std::string& out, int64_t offsetCs) const {
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        forEachSpeakerRun(i, [&](const SpeakerRun& run) {
+            const std::string_view text = trim(run.text);
+            if (text.empty()) return;
+
+            out += formatClock(run.t0 + offsetCs, '.') + " --> " + formatClock(run.t1 + offsetCs, '.') + "\n";
+            if (run.speaker >= 0) {
+                out += "<v Speaker " + std::to_string(run.speaker + 1) + ">";
+            }
+            out += text;
+            out += "\n\n";
+        });
+    }
+}
+
+json TranscriptResult::toJson() const {
+    json j;
+    j["duration"] = durationCs_;
+    if (!ok()) {
+        j["error"] = error_;
+        return j;
+    }
+
+    json segments = json::array();
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        const Segment& segment = segments_[i];
+        // Tokens as compact [id, t0, t1, p, text] rows; history files can get long
+        json tokens = json::array();
+        for (uint32_t k = 0; k < segment.tokenCount; ++k) {
+            const Token& token = tokens_[segment.firstToken + k];
+            tokens.push_back({token.id, token.t0, token.t1, token.p, textToJson(tokenText(token))});
+        }
+        // Words as [t0, t1, speaker, text]; rebuilt from the tokens on load, only the speaker is read back
+        json words = json::array();
+        for (uint32_t k = 0; k < segment.wordCount; ++k) {
+            const Word& word = words_[segment.firstWord + k];
+            words.push_back({word.t0, word.t1, word.speaker, textToJson(trim(wordText(word)))});
+        }
+        segments.push_back({
+            {"t0", segment.t0},
+            {"t1", segment.t1},
+            {"speaker", segment.speaker},
+            {"text", textToJson(segmentText(i))},
+            {"tokens", tokens},
+            {"words", words}
+        });
+    }
+    j["segments"] = segments;
+    return j;
+}
+
+TranscriptResult TranscriptResult::fromJson(const json& j) {
+    if (j.contains("error")) {
+        return failure(j.value("error", ""));
+    }
+
+    TranscriptResult result;
+    result.durationCs_ = j.value("duration", static_cast<int64_t>(0));
+    if (!j.contains("segments")) return result;
+
+    for (const auto& segment : j["segments"]) {
+        result.addSegment(segment.value("t0", static_cast<int64_t>(0)),
+                          segment.value("t1", static_cast<int64_t>(0)),
+                          segment.contains("text") ? textFromJson(segment["text"]) : std::string(),
+                          segment.value("speaker", -1));
+        if (!segment.contains("tokens")) continue;
+        for (const auto& token : segment["tokens"]) {
+            if (!token.is_array() || token.size() < 5) continue;
+            result.addToken(token[0].get<int>(), token[1].get<int64_t>(), token[2].get<int64_t>(),
+                            token[3].get<float>(), textFromJson(token[4]));
+        }
+        if (!segment.contains("words")) continue;
+        const Segment& added = result.segments_.back();
+        const json& words = segment["words"];
+        if (words.size() != added.wordCount) continue;
+        for (uint32_t k = 0; k < added.wordCount; ++k) {
+            if (words[k].is_array() && words[k].size() >= 3) {
+                result.words_[added.firstWord + k].speaker = words[k][2].get<int>();
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <nlohmann/json_fwd.hpp>
+
+// Structured output of a transcription job.
+// Segments and tokens are kept in flat arrays and all text lives in one
+// character pool referenced by offset, so even multi-hour results are a few
+// allocations. Nothing is formatted up front: each sink (history view, SRT,
+// VTT, JSON) renders what it needs, so re-formatting never needs another
+// whisper_full pass. Times are in centiseconds, like whisper's own.
+// Words are grouped from tokens as they arrive (see opensWord) and carry their
+// own speaker, so a segment in which two people trade turns is split at the
+// change by every sink.
+class TranscriptResult {
+public:
+    struct Segment {
+        int64_t t0 = 0;
+        int64_t t1 = 0;
+        int speaker = -1;           // Diarization speaker index, -1 if unknown
+        uint32_t textOffset = 0;
+        uint32_t textLength = 0;
+        uint32_t firstToken = 0;    // Index into tokens
+        uint32_t tokenCount = 0;
+        uint32_t firstWord = 0;     // Index into words
+        uint32_t wordCount = 0;
+    };
+
+    struct Token {
+        int id = 0;
+        int64_t t0 = 0;
+        int64_t t1 = 0;
+        float p = 0.0f;             // Token probability
+        uint32_t textOffset = 0;
+        uint32_t textLength = 0;
+    };
+
+    // Consecutive tokens of one segment; their text is contiguous in the pool
+    struct Word {
+        int64_t t0 = 0;
+        int64_t t1 = 0;
+        int speaker = -1;
+        uint32_t textOffset = 0;
+        uint32_t textLength = 0;
+    };
+
+    TranscriptResult() = default;
+    static TranscriptResult failure(const std::string& message);
+    // A single segment covering [0, durationCs), e.g. for text edited by hand
+    static TranscriptResult fromText(const std::string& text, int64_t durationCs);
+
+    bool ok() const { return error_.empty(); }
+    const std::string& getError() const { return error_; }
+    bool empty() const { return segments_.empty(); }
+
+    // Building. Tokens belong to the most recently added segment.
+    void addSegment(int64_t t0, int64_t t1, std::string_view text, int speaker = -1);
+    void addToken(int id, int64_t t0, int64_t t1, float p, std::string_view text);
+    // Whether a token begins a word: one with a leading space, or one starting
+    // with a character of a script written without spaces (CJK, kana, Thai, ...),
+    // where each such token counts as a word of its own
+    static bool opensWord(std::string_view tokenText);
+    void setSpeaker(size_t segment, int speaker) { segments_[segment].speaker = speaker; }
+    void setWordSpeaker(size_t word, int speaker) { words_[word].speaker = speaker; }
+    // Length of the audio that was transcribed
+    void setDuration(int64_t durationCs) { durationCs_ = durationCs; }
+    int64_t getDuration() const { return durationCs_; }
+
+    // Move every timestamp by offsetCs (e.g. a live segment's position in the session)
+    void shiftTimes(int64_t offsetCs);
+    // Pass every timestamp through map (e.g. from VAD-compacted audio back to file time)
+    void mapTimes(const std::function<int64_t(int64_t)>& map);
+    // Append another result whose times start at offsetCs in this one
+    void append(const TranscriptResult& other, int64_t offsetCs);
+
+    size_t segmentCount() const { return segments_.size(); }
+    const Segment& segment(size_t i) const { return segments_[i]; }
+    const std::vector<Segment>& getSegments() const { return segments_; }
+    const std::vector<Token>& getTokens() const { return tokens_; }
+    size_t wordCount() const { return words_.size(); }
+    const Word& word(size_t i) const { return words_[i]; }
+    const std::vector<Word>& getWords() const { return words_; }
+    std::string_view segmentText(size_t i) const;
+    std::string_view tokenText(const Token& token) const;
+    std::string_view wordText(const Word& word) const;
+
+    // Sinks
+    // Plain text as shown in the history, optionally with [mm:ss.mmm --> mm:ss.mmm] prefixes
+    std::string toText(bool timestamps) const;
+    // SRT cues, numbered from cueIndex (advanced past the last cue written)
+    void appendSrt(std::string& out, int& cueIndex, int64_t offsetCs = 0) const;
+    // WebVTT cues; the caller writes the "WEBVTT" header
+    void appendVtt(std::string& out, int64_t offsetCs = 0) const;
+    // Lossless: text that isn't valid UTF-8 (a token ending inside a character)
+    // is written as an array of byte values rather than a JSON string
+    nlohmann::json toJson() const;
+    static TranscriptResult fromJson(const nlohmann::json& j);
+
+private:
+    uint32_t storeText(std::string_view text);
+
+    // Stretch of a segment spoken by one speaker; the whole segment unless its words change speaker
+    struct SpeakerRun {
+        int64_t t0;
+        int64_t t1;
+        int speaker;
+        std::string_view text;
+    };
+    template <typename Fn>
+    void forEachSpeakerRun(size_t segment, Fn&& fn) const;
+
+    std::vector<Segment> segments_;
+    std::vector<Token> tokens_;
+    std::vector<Word> words_;
+    std::string textPool_;
+    int64_t durationCs_ = 0;
+    std::string error_;
+};
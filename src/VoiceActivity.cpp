@@ -0,0 +1,157 @@
+#include "VoiceActivity.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace VoiceActivity {
+
+namespace {
+    constexpr size_t kFftSize = 512;
+    constexpr double kPi = 3.14159265358979323846;
+
+    // In-place radix-2 FFT; size is a power of two
+    void fft(std::vector<std::complex<float>>& data, const std::vector<std::complex<float>>& twiddles) {
+        const size_t n = data.size();
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(data[i], data[j]);
+        }
+        for (size_t length = 2; length <= n; length <<= 1) {
+            const size_t step = n / length;
+            for (size_t i = 0; i < n; i += length) {
+                for (size_t k = 0; k < length / 2; ++k) {
+                    const std::complex<float> t = twiddles[k * step] * data[i + k + length / 2];
+                    data[i + k + length / 2] = data[i + k] - t;
+                    data[i + k] += t;
+                }
+            }
+        }
+    }
+}
+
+std::vector<Region> detect(const float* samples, size_t numSamples, int sampleRate, const Options& options) {
+    std::vector<Region> regions;
+    if (numSamples == 0 || sampleRate <= 0) return regions;
+
+    const size_t hop = std::max(1, sampleRate / 50);
+    const size_t frameLength = std::min(kFftSize, hop * 2);
+    const size_t numFrames = (numSamples + hop - 1) / hop;
+
+    std::vector<float> window(frameLength);
+    for (size_t i = 0; i < frameLength; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / frameLength));
+    }
+    std::vector<std::complex<float>> twiddles(kFftSize / 2);
+    for (size_t k = 0; k < twiddles.size(); ++k) {
+        twiddles[k] = std::polar(1.0f, static_cast<float>(-2.0 * kPi * k / kFftSize));
+    }
+    // Telephone band, where voiced speech has its harmonics
+    const size_t lowBin = std::max<size_t>(1, 300 * kFftSize / static_cast<size_t>(sampleRate));
+    const size_t highBin = std::min(kFftSize / 2, std::max(lowBin + 1, 3400 * kFftSize / static_cast<size_t>(sampleRate)));
+
+    std::vector<float> energyDb(numFrames);
+    std::vector<float> flatness(numFrames);
+    std::vector<std::complex<float>> spectrum(kFftSize);
+    for (size_t f = 0; f < numFrames; ++f) {
+        const size_t begin = f * hop;
+        const size_t end = std::min(numSamples, begin + frameLength);
+
+        double energy = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            energy += static_cast<double>(samples[i]) * samples[i];
+        }
+        energyDb[f] = static_cast<float>(10.0 * std::log10(energy / static_cast<double>(end - begin) + 1e-12));
+
+        std::fill(spectrum.begin(), spectrum.end(), std::complex<float>(0.0f, 0.0f));
+        for (size_t i = begin; i < end; ++i) {
+            spectrum[i - begin] = samples[i] * window[i - begin];
+        }
+        fft(spectrum, twiddles);
+        double logSum = 0.0;
+        double sum = 0.0;
+        for (size_t k = lowBin; k < highBin; ++k) {
+            const double power = std::norm(spectrum[k]) + 1e-12;
+            logSum += std::log(power);
+            sum += power;
+        }
+        const double bins = static_cast<double>(highBin - lowBin);
+        flatness[f] = static_cast<float>(std::exp(logSum / bins) / (sum / bins));
+    }
+
+    // Noise floor: the level the quietest tenth of the recording sits at
+    std::vector<float> sorted(energyDb);
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(sorted.size() / 10), sorted.end());
+    const float noiseFloor = std::max(sorted[sorted.size() / 10], -70.0f);
+    const float speechLevel = noiseFloor + options.thresholdDb;
+    // Loud enough that flatness doesn't matter (fricatives, laughter, crosstalk)
+    const float loudLevel = speechLevel + 12.0f;
+
+    std::vector<Region> runs;
+    const size_t minSpeechFrames = static_cast<size_t>(options.minSpeechSeconds * 50.0f);
+    for (size_t f = 0; f < numFrames;) {
+        auto isSpeech = [&](size_t i) {
+            return energyDb[i] > loudLevel || (energyDb[i] > speechLevel && flatness[i] < options.maxFlatness);
+        };
+        if (!isSpeech(f)) {
+            ++f;
+            continue;
+        }
+        const size_t first = f;
+        while (f < numFrames && isSpeech(f)) ++f;
+        if (f - first >= minSpeechFrames) {
+            runs.push_back({first * hop, std::min(numSamples, f * hop)});
+        }
+    }
+
+    // Pad, then bridge pauses too short to be worth cutting
+    const size_t padding = static_cast<size_t>(options.paddingSeconds * sampleRate);
+    const size_t minSilence = static_cast<size_t>(options.minSilenceSeconds * sampleRate);
+    for (const Region& run : runs) {
+        Region padded{run.start > padding ? run.start - padding : 0, std::min(numSamples, run.end + padding)};
+        if (!regions.empty() && padded.start <= regions.back().end + minSilence) {
+            regions.back().end = std::max(regions.back().end, padded.end);
+        } else {
+            regions.push_back(padded);
+        }
+    }
+    return regions;
+}
+
+CompactAudio compact(const float* samples, size_t numSamples, int sampleRate, const std::vector<Region>& regions) {
+    CompactAudio result;
+    result.sampleRate = sampleRate;
+    size_t total = 0;
+    for (const Region& region : regions) {
+        total += std::min(region.end, numSamples) - std::min(region.start, numSamples);
+    }
+    result.samples.reserve(total);
+    result.spans.reserve(regions.size());
+    for (const Region& region : regions) {
+        const size_t start = std::min(region.start, numSamples);
+        const size_t end = std::min(region.end, numSamples);
+        if (end <= start) continue;
+        result.spans.push_back({result.samples.size(), start, end - start});
+        result.samples.insert(result.samples.end(), samples + start, samples + end);
+    }
+    return result;
+}
+
+int64_t CompactAudio::toOriginalCs(int64_t compactCs) const {
+    if (spans.empty() || sampleRate <= 0) return compactCs;
+    const int64_t position = std::max<int64_t>(0, compactCs) * sampleRate / 100;
+    // Last span starting at or before the position
+    auto it = std::upper_bound(spans.begin(), spans.end(), static_cast<size_t>(position),
+                               [](size_t value, const Span& span) { return value < span.compactStart; });
+    if (it != spans.begin()) --it;
+    const size_t within = std::min(static_cast<size_t>(position) - std::min(static_cast<size_t>(position), it->compactStart), it->length);
+    return static_cast<int64_t>(it->originalStart + within) * 100 / sampleRate;
+}
+
+int64_t encoderWindows(size_t numSamples, int sampleRate) {
+    const size_t window = static_cast<size_t>(sampleRate) * 30;
+    return window > 0 ? static_cast<int64_t>((numSamples + window - 1) / window) : 0;
+}
+
+} // namespace VoiceActivity
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Voice activity detection for the pre-pass that strips silence before whisper.
+// Each 20 ms frame is scored on energy above the recording's noise floor and
+// on spectral flatness in the speech band (voiced speech is peaky, hiss and
+// hum are flat). Speech runs are padded and short pauses bridged, so only
+// stretches of real silence are removed.
+namespace VoiceActivity {
+
+struct Options {
+    float thresholdDb = 9.0f;        // Energy above the noise floor needed for speech
+    float maxFlatness = 0.45f;       // Spectral flatness above which a quiet frame counts as noise
+    float minSpeechSeconds = 0.25f;  // Shorter bursts are dropped as clicks
+    float minSilenceSeconds = 0.6f;  // Shorter pauses are kept
+    float paddingSeconds = 0.2f;     // Kept on both sides of every speech region
+};
+
+struct Region {
+    size_t start; // First sample
+    size_t end;   // One past the last sample
+};
+
+// Speech regions in order, non-overlapping
+std::vector<Region> detect(const float* samples, size_t numSamples, int sampleRate, const Options& options = Options());
+
+// Speech-only copy of a recording plus the map back to original sample positions
+struct CompactAudio {
+    struct Span {
+        size_t compactStart;
+        size_t originalStart;
+        size_t length;
+    };
+    std::vector<float> samples;
+    std::vector<Span> spans;
+    int sampleRate = 16000;
+
+    // Position in the compacted buffer (centiseconds) -> position in the original recording
+    int64_t toOriginalCs(int64_t compactCs) const;
+};
+
+CompactAudio compact(const float* samples, size_t numSamples, int sampleRate, const std::vector<Region>& regions);
+
+// Number of 30 s encoder windows whisper runs over numSamples
+int64_t encoderWindows(size_t numSamples, int sampleRate);
+
+} // namespace VoiceActivity
@@ -0,0 +1,171 @@
+#include "WavReader.h"
+#include "SampleConvert.h"
+#include "Resampler.h"
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+    // Long recordings are fine, but refuse anything that would blow up memory
+    constexpr size_t kMaxFrames = static_cast<size_t>(48000) * 60 * 60 * 8; // 8 hours at 48 kHz
+    constexpr size_t kResampleChunkFrames = 16384;
+
+    uint16_t readU16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    uint32_t readU32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+}
+
+WavReader::~WavReader() {
+    close();
+}
+
+bool WavReader::open(const std::string& path) {
+    close();
+
+    // Share like ifstream does, so files another process is still writing open too
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    file_ = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < 12) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    mapping_ = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping_) {
+        close();
+        return false;
+    }
+
+    view_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!view_) {
+        close();
+        return false;
+    }
+
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WavReader::close() {
+    if (view_) {
+        UnmapViewOfFile(view_);
+        view_ = nullptr;
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    if (file_) {
+        CloseHandle(file_);
+        file_ = nullptr;
+    }
+    size_ = 0;
+    data_ = nullptr;
+    frameCount_ = 0;
+    sampleRate_ = 0;
+    channels_ = 0;
+}
+
+bool WavReader::parse() {
+    if (std::memcmp(view_, "RIFF", 4) != 0) return false;
+    if (std::memcmp(view_ + 8, "WAVE", 4) != 0) return false;
+
+    bool foundFmt = false;
+    bool foundData = false;
+    uint16_t bitsPerSample = 0;
+    size_t dataOffset = 0;
+    size_t dataSize = 0;
+    size_t offset = 12;
+
+    while (offset + 8 <= size_ && (!foundFmt || !foundData)) {
+        const uint8_t* chunk = view_ + offset;
+        const uint32_t chunkSize = readU32(chunk + 4);
+        const size_t body = offset + 8;
+        // Recorders that are killed mid-write leave an oversized data chunk; clamp to the file
+        const size_t available = std::min<size_t>(chunkSize, size_ - body);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (available < 16) return false;
+            const uint8_t* fmt = view_ + body;
+            channels_ = readU16(fmt + 2);
+            sampleRate_ = static_cast<int>(readU32(fmt + 4));
+            bitsPerSample = readU16(fmt + 14);
+            foundFmt = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            dataOffset = body;
+            dataSize = available;
+            foundData = true;
+        }
+
+        offset = body + chunkSize + (chunkSize % 2); // chunks are word-aligned
+    }
+
+    if (!foundFmt || !foundData) return false;
+    if (bitsPerSample != 16) return false;
+    if (channels_ != 1 && channels_ != 2) return false;
+
+    const size_t bytesPerFrame = static_cast<size_t>(channels_) * sizeof(int16_t);
+    frameCount_ = dataSize / bytesPerFrame;
+    if (frameCount_ == 0 || frameCount_ > kMaxFrames) return false;
+
+    data_ = reinterpret_cast<const int16_t*>(view_ + dataOffset);
+    return true;
+}
+
+size_t WavReader::readMono(size_t firstFrame, size_t frameCount, float* out) const {
+    if (!data_ || firstFrame >= frameCount_) return 0;
+    frameCount = std::min(frameCount, frameCount_ - firstFrame);
+
+    if (channels_ == 1) {
+        SampleConvert::s16ToFloat(data_ + firstFrame, out, frameCount);
+    } else {
+        SampleConvert::s16StereoToMonoFloat(data_ + firstFrame * 2, out, frameCount);
+    }
+    return frameCount;
+}
+
+bool WavReader::readFile(const std::string& path, std::vector<float>& pcmf32, int& sampleRate, int& channels,
+                         int targetSampleRate) {
+    WavReader reader;
+    if (!reader.open(path)) return false;
+
+    sampleRate = reader.getSampleRate();
+    channels = reader.getChannels();
+
+    // An unsupported ratio is read at the native rate so the caller can report or fall back
+    Resampler resampler;
+    if (targetSampleRate <= 0 || targetSampleRate == sampleRate ||
+        !resampler.configure(sampleRate, targetSampleRate)) {
+        pcmf32.resize(reader.getFrameCount());
+        const size_t framesRead = reader.readMono(0, pcmf32.size(), pcmf32.data());
+        pcmf32.resize(framesRead);
+        return !pcmf32.empty();
+    }
+
+    // Convert and resample one cache-sized chunk at a time
+    pcmf32.clear();
+    pcmf32.reserve(static_cast<size_t>(resampler.outputLength(reader.getFrameCount())));
+    std::vector<float> chunk(kResampleChunkFrames);
+    for (size_t first = 0; first < reader.getFrameCount(); first += chunk.size()) {
+        const size_t n = reader.readMono(first, chunk.size(), chunk.data());
+        resampler.process(chunk.data(), n, pcmf32);
+    }
+    resampler.flush(pcmf32);
+
+    sampleRate = targetSampleRate;
+    return !pcmf32.empty();
+}
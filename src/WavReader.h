@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Memory-mapped reader for 16-bit PCM WAV files.
+// The file is mapped read-only and the RIFF chunks are parsed in place, so
+// samples go straight from the page cache into the float conversion kernels
+// without an intermediate copy.
+class WavReader {
+public:
+    WavReader() = default;
+    ~WavReader();
+
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    // Map the file and parse its header. Returns false for anything other
+    // than 16-bit mono or stereo PCM.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    int getSampleRate() const { return sampleRate_; }
+    int getChannels() const { return channels_; }
+    size_t getFrameCount() const { return frameCount_; }
+
+    // Convert frames [firstFrame, firstFrame + frameCount) to mono float.
+    // Returns the number of frames written to out.
+    size_t readMono(size_t firstFrame, size_t frameCount, float* out) const;
+
+    // Read the whole file as mono float. With a targetSampleRate the audio is
+    // resampled chunk by chunk as it is converted and sampleRate reports the target.
+    static bool readFile(const std::string& path, std::vector<float>& pcmf32, int& sampleRate, int& channels,
+                         int targetSampleRate = 0);
+
+private:
+    bool parse();
+
+    void* file_ = nullptr;      // HANDLE
+    void* mapping_ = nullptr;   // HANDLE
+    const uint8_t* view_ = nullptr;
+    size_t size_ = 0;
+
+    const int16_t* data_ = nullptr;
+    size_t frameCount_ = 0;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+};
@@ -1,32 +1,96 @@
 #include "WhisperEngine.h"
 #include "SpeakerDiarizer.h"
+#include "SpeakerAlignment.h"
+#include "WhisperModel.h"
+#include "ModelCache.h"
+#include "EncoderCache.h"
+#include "ResultCache.h"
+#include "WavReader.h"
+#include "AudioDecoder.h"
+#include "SampleConvert.h"
+#include "SilenceSplitter.h"
+#include "VoiceActivity.h"
+#include "CpuInfo.h"
+#include "JobControl.h"
 #include "Logger.h"
 #include <whisper.h>
-#include <fstream>
 #include <iostream>
-#include <cstring>
 #include <cmath>
+#include <cstdio>
 #include <thread>
 #include <filesystem>
 #include <chrono>
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <map>
+#include <future>
+#include <functional>
 
-WhisperEngine::WhisperEngine() : diarizer_(std::make_unique<SpeakerDiarizer>()) {
+namespace {
+    // Mean probability of a result's text tokens (1 if there are none)
+    float meanTokenProbability(const TranscriptResult& result) {
+        const std::vector<TranscriptResult::Token>& tokens = result.getTokens();
+        if (tokens.empty()) return 1.0f;
+        double sum = 0.0;
+        for (const TranscriptResult::Token& token : tokens) sum += token.p;
+        return static_cast<float>(sum / static_cast<double>(tokens.size()));
+    }
+
+    // Diarization running alongside a decode. Leaving transcribe() by any path
+    // clears the job's diarizing flag; an early exit also asks the diarizer to
+    // stop, since its result won't be used.
+    struct DiarizationTask {
+        std::future<std::vector<SpeakerSegment>> future;
+        std::shared_ptr<std::atomic<bool>> abandoned = std::make_shared<std::atomic<bool>>(false);
+        JobControl* control = nullptr;
+
+        ~DiarizationTask() {
+            if (future.valid()) {
+                *abandoned = true;
+                future.wait();
+            }
+            if (control) control->setDiarizing(false);
+        }
+    };
+}
+
+WhisperEngine::WhisperEngine()
+    : modelCache_(std::make_unique<ModelCache>()), encoderCache_(std::make_shared<EncoderCache>()),
+      diarizer_(std::make_unique<SpeakerDiarizer>()) {
+    // A model freed after an eviction or swap takes its retained states with it
+    std::weak_ptr<EncoderCache> encoderCache = encoderCache_;
+    modelCache_->setUnloadHook([encoderCache](const WhisperModel* model) {
+        if (std::shared_ptr<EncoderCache> cache = encoderCache.lock()) cache->dropModel(model);
+    });
     // whisper_log_set(nullptr, nullptr); // Disable logs if needed
 }
 
-std::string WhisperEngine::transcribeFile(const std::string& audioPath) {
+TranscriptResult WhisperEngine::transcribeFile(const std::string& audioPath, const std::string& modelPath,
+                                               JobControl* control, Task task, LanguagePin* languagePin,
+                                               const JobSettings* settings) {
     namespace fs = std::filesystem;
     std::string extension = fs::path(audioPath).extension().string();
     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
 
     if (extension == ".wav") {
-        std::string result = transcribe(audioPath);
-        if (result.find("Error: Unsupported sample rate") == std::string::npos) {
+        TranscriptResult result = transcribe(audioPath, modelPath, control, task, languagePin, settings);
+        if (result.getError().find("Error: Unsupported sample rate") == std::string::npos) {
             return result;
         }
+    } else if (AudioDecoder::detectFormat(audioPath) != AudioDecoder::Format::Unknown) {
+        // Decode in-process; ffmpeg is only needed for formats we can't handle
+        std::vector<float> pcmf32;
+        int sampleRate = 0;
+        if (AudioDecoder::decodeFile(audioPath, pcmf32, sampleRate, 16000)) {
+            if (sampleRate == 16000) {
+                return transcribe(pcmf32.data(), pcmf32.size(), sampleRate, modelPath, control, task, languagePin,
+                                  settings);
+            }
+            LOG_INFO("No resampler for " + std::to_string(sampleRate) + " Hz audio, converting with ffmpeg");
+        } else {
+            LOG_WARNING("Built-in decoder failed, falling back to ffmpeg: " + audioPath);
+        }
     }
 
     auto timestamp = std::chrono::high_resolution_clock::now().time_since_epoch().count();
@@ -35,10 +99,10 @@ std::string WhisperEngine::transcribeFile(const std::string& audioPath) {
     std::string command = "ffmpeg -y -i \"" + audioPath + "\" -ac 1 -ar 16000 -c:a pcm_s16le \"" + tempPath.string() + "\"";
     int ret = system(command.c_str());
     if (ret != 0 || !fs::exists(tempPath)) {
-        return "Error: Failed to convert audio file. Please install ffmpeg.";
+        return TranscriptResult::failure("Error: Failed to convert audio file. Please install ffmpeg.");
     }
 
-    std::string result = transcribe(tempPath.string());
+    TranscriptResult result = transcribe(tempPath.string(), modelPath, control, task, languagePin, settings);
     try {
         fs::remove(tempPath);
     } catch (...) {
@@ -47,244 +111,1491 @@ std::string WhisperEngine::transcribeFile(const std::string& audioPath) {
 }
 
 WhisperEngine::~WhisperEngine() {
-    if (ctx_) {
-        whisper_free(ctx_);
+    {
+        // Drop queued loads; the one in progress finishes first
+        std::lock_guard<std::mutex> lock(loaderMutex_);
+        requestedModel_.clear();
     }
+    if (loaderThread_.joinable()) loaderThread_.join();
+    // Retained states go back to their pools while the models still exist
+    encoderCache_.reset();
+    std::lock_guard<std::mutex> lock(modelMutex_);
+    model_.reset();
+    modelCache_.reset();
 }
 
 bool WhisperEngine::loadModel(const std::string& modelPath) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (ctx_) {
-        whisper_free(ctx_);
-        ctx_ = nullptr;
+    // Loads are serialized, but jobs keep running on the current model meanwhile
+    std::lock_guard<std::mutex> loadLock(loadMutex_);
+    setModelState(ModelState::Loading);
+    std::string previousName;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        previousName = modelName_;
+        modelName_ = std::filesystem::path(modelPath).filename().string();
     }
 
     LOG_INFO("Loading whisper model: " + modelPath);
-
-    struct whisper_context_params cparams = whisper_context_default_params();
-    // cparams.use_gpu = true; // if available, auto-detected usually
-
-    ctx_ = whisper_init_from_file_with_params(modelPath.c_str(), cparams);
-    if (!ctx_) {
-        LOG_ERROR("Failed to initialize whisper context from " + modelPath);
-        std::cerr << "Failed to initialize whisper context from " << modelPath << std::endl;
+    // Switching back to a model that's still cached costs nothing
+    std::shared_ptr<WhisperModel> model = modelCache_->acquire(modelPath, getPoolCapacity());
+    if (!model) {
+        // Whatever was loaded before stays in service
+        if (modelLoaded_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            modelName_ = previousName;
+        }
+        setModelState(modelLoaded_ ? ModelState::Ready : ModelState::Failed);
         return false;
     }
+
+    // Swap. The previous model stays cached until the budget pushes it out,
+    // and is freed after that by its last running job.
+    {
+        std::lock_guard<std::mutex> lock(modelMutex_);
+        model_ = std::move(model);
+    }
+    modelCache_->pin(modelPath);
+
+    updateDiarizationThreads(); // Calibrations are per model
+
+    modelLoaded_ = true;
+    setModelState(ModelState::Ready);
     LOG_INFO("Whisper model loaded successfully");
     return true;
 }
 
-std::string WhisperEngine::transcribe(const std::string& wavPath) {
+std::shared_ptr<WhisperModel> WhisperEngine::currentModel() const {
+    std::lock_guard<std::mutex> lock(modelMutex_);
+    return model_;
+}
+
+std::shared_ptr<WhisperModel> WhisperEngine::modelFor(const std::string& modelPath) {
+    std::shared_ptr<WhisperModel> current = currentModel();
+    if (modelPath.empty() || (current && current->getPath() == modelPath)) {
+        return current;
+    }
+    return modelCache_->acquire(modelPath, getPoolCapacity());
+}
+
+void WhisperEngine::setModelCacheBudgetMB(int megabytes) {
+    modelCache_->setBudgetBytes(static_cast<uint64_t>(std::max(0, megabytes)) * 1024 * 1024);
+}
+
+WhisperEngine::ModelCacheStats WhisperEngine::getModelCacheStats() const {
+    const ModelCache::Stats cache = modelCache_->getStats();
+    ModelCacheStats stats;
+    stats.hits = cache.hits;
+    stats.misses = cache.misses;
+    stats.evictions = cache.evictions;
+    stats.residentBytes = cache.residentBytes;
+    stats.budgetBytes = cache.budgetBytes;
+    stats.residentModels = cache.residentModels;
+    return stats;
+}
+
+// =============================================================================
+// BACKGROUND LOADING
+// =============================================================================
+// One loader thread serves load requests; if several arrive while a model is
+// loading only the latest one is kept. After loading, a short silent decode
+// pages in the weights and allocates the state's compute buffers so the
+// first real transcription doesn't pay for them.
+
+void WhisperEngine::loadModelAsync(const std::string& modelPath) {
+    std::lock_guard<std::mutex> lock(loaderMutex_);
+    requestedModel_ = modelPath;
+    // Workers waiting in waitForModel() must not start their own load meanwhile
+    setModelState(ModelState::Loading);
+    if (loaderRunning_) return;
+    if (loaderThread_.joinable()) loaderThread_.join(); // Already past its last request
+    loaderRunning_ = true;
+    loaderThread_ = std::thread(&WhisperEngine::loaderLoop, this);
+}
+
+void WhisperEngine::loaderLoop() {
+    for (;;) {
+        std::string modelPath;
+        {
+            std::lock_guard<std::mutex> lock(loaderMutex_);
+            if (requestedModel_.empty()) {
+                loaderRunning_ = false;
+                return;
+            }
+            modelPath.swap(requestedModel_);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if (!loadModel(modelPath)) continue;
+        const auto loaded = std::chrono::steady_clock::now();
+        warmUp();
+        const auto ready = std::chrono::steady_clock::now();
+        LOG_INFO("Model ready in " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(ready - start).count())
+                 + " ms (load " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(loaded - start).count())
+                 + " ms, warm-up " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(ready - loaded).count()) + " ms)");
+    }
+}
+
+void WhisperEngine::warmUp() {
+    std::shared_ptr<WhisperModel> model = currentModel();
+    if (!model) return;
+    setModelState(ModelState::WarmingUp);
+
+    {
+        WhisperStatePool::Lease state = model->states().acquire();
+        if (state) {
+            const std::vector<float> silence(16000, 0.0f);
+            whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+            wparams.print_progress = false;
+            wparams.print_special = false;
+            wparams.print_realtime = false;
+            wparams.print_timestamps = false;
+            wparams.language = "en";
+            wparams.no_context = true;
+            wparams.single_segment = true;
+            wparams.max_tokens = 4;
+            wparams.n_threads = getEffectiveThreadsPerJob();
+            if (whisper_full_with_state(model->context(), state.get(), wparams, silence.data(), static_cast<int>(silence.size())) != 0) {
+                LOG_WARNING("Warm-up inference failed");
+            }
+        }
+    }
+    setModelState(ModelState::Ready);
+}
+
+void WhisperEngine::setModelState(ModelState state) {
+    {
+        std::lock_guard<std::mutex> lock(modelStateMutex_);
+        modelState_ = state;
+    }
+    modelStateChanged_.notify_all();
+}
+
+WhisperEngine::ModelState WhisperEngine::getModelState() const {
+    std::lock_guard<std::mutex> lock(modelStateMutex_);
+    return modelState_;
+}
+
+const char* WhisperEngine::modelStateName(ModelState state) {
+    switch (state) {
+        case ModelState::Unloaded: return "No model";
+        case ModelState::Loading: return "Loading";
+        case ModelState::WarmingUp: return "Warming up";
+        case ModelState::Ready: return "Ready";
+        case ModelState::Failed: return "Failed to load";
+    }
+    return "Unknown";
+}
+
+std::string WhisperEngine::languageCode(int languageId) {
+    const char* code = languageId >= 0 ? whisper_lang_str(languageId) : nullptr;
+    return code ? code : "";
+}
+
+bool WhisperEngine::waitForModel() {
+    std::unique_lock<std::mutex> lock(modelStateMutex_);
+    modelStateChanged_.wait(lock, [this]() { return modelState_ != ModelState::Loading; });
+    return modelLoaded_;
+}
+
+void WhisperEngine::setMaxConcurrentJobs(int jobs) {
+    jobs = std::max(1, jobs);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxConcurrentJobs_ = jobs;
+    }
+    updatePoolCapacity();
+    updateDiarizationThreads();
+}
+
+void WhisperEngine::setThreadsPerJob(int threads) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threadsPerJob_ = threads;
+    }
+    updateDiarizationThreads();
+}
+
+void WhisperEngine::setDiarizationThreads(int threads) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        diarizationThreads_ = threads;
+    }
+    updateDiarizationThreads();
+}
+
+int WhisperEngine::getMaxConcurrentJobs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxConcurrentJobs_;
+}
+
+int WhisperEngine::getEffectiveThreadsPerJob() const {
+    return threadsPerJobFor(getModelName());
+}
+
+int WhisperEngine::threadsPerJobFor(const std::string& modelName) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (!ctx_) return "Error: Model not loaded.";
+    if (threadsPerJob_ > 0) {
+        return threadsPerJob_;
+    }
+    // Split the calibrated count (or the physical cores) evenly between concurrent jobs
+    int threads = CpuInfo::physicalCores();
+    auto it = calibrations_.find(modelName);
+    if (it != calibrations_.end() && it->second.whisperThreads > 0) {
+        threads = it->second.whisperThreads;
+    }
+    return std::max(1, threads / std::max(1, maxConcurrentJobs_));
+}
+
+int WhisperEngine::getEffectiveDiarizationThreads(int jobThreads) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (diarizationThreads_ > 0) {
+            return std::min(diarizationThreads_, std::max(1, jobThreads - 1));
+        }
+        auto it = calibrations_.find(modelName_);
+        if (it != calibrations_.end() && it->second.diarizationThreads > 0) {
+            return std::min(it->second.diarizationThreads, std::max(1, jobThreads - 1));
+        }
+    }
+    // A quarter of the job's threads (at least one) - the ONNX models are much
+    // cheaper than the whisper encoder/decoder, so this keeps both finishing together
+    return std::max(1, jobThreads / 4);
+}
+
+void WhisperEngine::updateDiarizationThreads() {
+    if (diarizer_) {
+        diarizer_->setNumThreads(getEffectiveDiarizationThreads(getEffectiveThreadsPerJob()));
+    }
+}
 
+TranscriptResult WhisperEngine::transcribe(const std::string& wavPath, const std::string& modelPath,
+                                           JobControl* control, Task task, LanguagePin* languagePin,
+                                           const JobSettings* settings) {
     std::vector<float> pcmf32;
     int sampleRate = 0;
     int channels = 0;
 
-    if (!readWav(wavPath, pcmf32, sampleRate, channels)) {
-        return "Error: Failed to read WAV file.";
+    // Resampled to 16 kHz while reading; rates the resampler rejects stay native
+    if (!WavReader::readFile(wavPath, pcmf32, sampleRate, channels, 16000)) {
+        return TranscriptResult::failure("Error: Failed to read WAV file.");
+    }
+
+    return transcribe(pcmf32.data(), pcmf32.size(), sampleRate, modelPath, control, task, languagePin, settings);
+}
+
+TranscriptResult WhisperEngine::transcribe(const int16_t* samples, size_t numSamples, int sampleRate,
+                                           const std::string& modelPath, JobControl* control, Task task,
+                                           LanguagePin* languagePin, const JobSettings* settings) {
+    std::vector<float> pcmf32(numSamples);
+    SampleConvert::s16ToFloat(samples, pcmf32.data(), numSamples);
+    return transcribe(pcmf32.data(), pcmf32.size(), sampleRate, modelPath, control, task, languagePin, settings);
+}
+
+TranscriptResult WhisperEngine::transcribe(const float* samples, size_t numSamples, int sampleRate,
+                                           const std::string& modelPath, JobControl* control, Task task,
+                                           LanguagePin* languagePin, const JobSettings* settings) {
+    // Snapshot settings so the GUI can change them while this job runs
+    const JobSettings snapshot = settings ? *settings : snapshotSettings(modelPath, task);
+
+    // Holding a reference keeps this model alive even if another one is swapped in mid-job
+    std::shared_ptr<WhisperModel> model = modelFor(snapshot.modelPath);
+    if (!model) {
+        return TranscriptResult::failure(snapshot.modelPath.empty() ? "Error: Model not loaded." : "Error: Failed to load model.");
+    }
+
+    std::string language = snapshot.language;
+    const bool translate = snapshot.translate;
+    const bool printTimestamps = snapshot.printTimestamps;
+    const bool speakerDiarization = snapshot.speakerDiarization;
+    const bool longFileChunking = snapshot.longFileChunking;
+    const bool skipSilence = snapshot.skipSilence;
+    const DecodingPresets::Preset preset = snapshot.preset;
+    const bool adaptiveAudioContext = snapshot.adaptiveAudioContext;
+    const int nThreads = threadsPerJobFor(model->getName());
+
+    if (numSamples == 0) {
+        return TranscriptResult::failure("Error: No audio samples.");
     }
 
     if (sampleRate != 16000) {
         // Simple decimation or error if rate is wrong.
         // AudioRecorder records at 16k, so this should match.
-        return "Error: Unsupported sample rate. Please record at 16kHz.";
+        return TranscriptResult::failure("Error: Unsupported sample rate. Please record at 16kHz.");
     }
 
-    // If speaker diarization is enabled and initialized, run it first
-    std::vector<SpeakerSegment> diarizationSegments;
-    if (speakerDiarization_ && diarizer_ && diarizer_->isInitialized()) {
-        diarizationSegments = diarizer_->process(pcmf32.data(), 
-                                                   static_cast<int>(pcmf32.size()), 
-                                                   sampleRate);
+    // Diarization reads the same buffer as whisper, so it runs alongside decoding
+    // (started below, once the early exits are behind us) and is joined before
+    // alignment. The diarizer is shared and serializes its runs, so its threads
+    // are budgeted once across all job slots rather than taken from every job.
+    const bool diarize = speakerDiarization && diarizer_ && diarizer_->isInitialized();
+    int whisperThreads = nThreads;
+    if (diarize) {
+        const int jobs = getMaxConcurrentJobs();
+        const int diarizationShare = (diarizer_->getNumThreads() + jobs - 1) / jobs;
+        whisperThreads = std::max(1, nThreads - diarizationShare);
     }
 
-    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    whisper_full_params wparams = DecodingPresets::params(preset, static_cast<float>(numSamples) / sampleRate);
     wparams.print_progress = false;
     wparams.print_special = false;
     wparams.print_realtime = false;
-    wparams.print_timestamps = printTimestamps_;
-    wparams.translate = translate_;
-    wparams.language = (language_ == "auto") ? nullptr : language_.c_str();
-    wparams.n_threads = std::thread::hardware_concurrency();
+    wparams.print_timestamps = printTimestamps;
+    wparams.translate = translate;
+    wparams.language = (language == "auto") ? nullptr : language.c_str();
+    wparams.n_threads = whisperThreads;
+    wparams.token_timestamps = true; // Per-token t0/t1 for TranscriptResult
+    if (control) {
+        // Checked between decoder steps and inside the encoder graph
+        wparams.abort_callback = [](void* data) {
+            return static_cast<JobControl*>(data)->isCancelled();
+        };
+        wparams.abort_callback_user_data = control;
+        wparams.progress_callback = [](whisper_context*, whisper_state*, int progress, void* data) {
+            static_cast<JobControl*>(data)->setDecodeProgress(progress);
+        };
+        wparams.progress_callback_user_data = control;
+    }
 
-    if (whisper_full(ctx_, wparams, pcmf32.data(), pcmf32.size()) != 0) {
-        return "Error: Transcription failed.";
+    // VAD pre-pass: whisper only sees the speech, and its timestamps are mapped
+    // back to the original recording afterwards. Diarization keeps the full audio.
+    const float* input = samples;
+    size_t inputSamples = numSamples;
+    VoiceActivity::CompactAudio speech;
+    bool compacted = false;
+    if (skipSilence) {
+        const std::vector<VoiceActivity::Region> regions = VoiceActivity::detect(samples, numSamples, sampleRate);
+        if (regions.empty()) {
+            LOG_INFO("VAD found no speech, skipping transcription");
+            TranscriptResult silent;
+            silent.setDuration(static_cast<int64_t>(numSamples) * 100 / sampleRate);
+            return silent;
+        }
+        speech = VoiceActivity::compact(samples, numSamples, sampleRate, regions);
+        // Not worth remapping timestamps for a few percent
+        if (speech.samples.size() < numSamples - numSamples / 20) {
+            const int64_t windowsBefore = VoiceActivity::encoderWindows(numSamples, sampleRate);
+            const int64_t windowsAfter = VoiceActivity::encoderWindows(speech.samples.size(), sampleRate);
+            const double hours = static_cast<double>(numSamples) / sampleRate / 3600.0;
+            LOG_INFO("VAD kept " + std::to_string(speech.samples.size() / sampleRate) + " of "
+                     + std::to_string(numSamples / sampleRate) + " s; encoder windows "
+                     + std::to_string(windowsBefore) + " -> " + std::to_string(windowsAfter) + " ("
+                     + std::to_string(static_cast<int>((windowsBefore - windowsAfter) / hours)) + " saved per hour)");
+            input = speech.samples.data();
+            inputSamples = speech.samples.size();
+            compacted = true;
+        }
     }
 
-    std::string result;
-    const int n_segments = whisper_full_n_segments(ctx_);
-    int lastSpeaker = -1;
-    
-    for (int i = 0; i < n_segments; ++i) {
-        const char* text = whisper_full_get_segment_text(ctx_, i);
-        const int64_t t0 = whisper_full_get_segment_t0(ctx_, i);
-        const int64_t t1 = whisper_full_get_segment_t1(ctx_, i);
-        
-        // Convert whisper timestamps (centiseconds) to seconds
-        float segmentStart = static_cast<float>(t0) / 100.0f;
-        float segmentEnd = static_cast<float>(t1) / 100.0f;
-        float segmentMid = (segmentStart + segmentEnd) / 2.0f;
-        
-        // Speaker diarization: find which speaker is talking at this segment's midpoint
-        if (speakerDiarization_ && !diarizationSegments.empty()) {
-            int currentSpeaker = -1;
-            
-            // Find the speaker segment that contains this whisper segment's midpoint
-            for (const auto& seg : diarizationSegments) {
-                if (segmentMid >= seg.start && segmentMid <= seg.end) {
-                    currentSpeaker = seg.speaker;
-                    break;
+    // Auto-detect mode: detect once per file or live session, not in every
+    // whisper_full call (each chunk of a long file, each live segment)
+    LanguagePin filePin;
+    LanguagePin& pin = languagePin ? *languagePin : filePin;
+    int pinnedLanguage = -1; // Set when this decode trusts an earlier detection
+    if (language == "auto" && whisper_is_multilingual(model->context())) {
+        int languageId = pin.get();
+        if (languageId >= 0) {
+            pinnedLanguage = languageId;
+        } else {
+            // Detection encodes a full window whatever the last job on a state did
+            WhisperStatePool::Lease state = model->states().acquireFullContext();
+            if (!state) {
+                return TranscriptResult::failure("Error: Could not allocate whisper state.");
+            }
+            float probability = 0.0f;
+            languageId = detectLanguage(*model, state.get(), input, inputSamples, nThreads, probability);
+            if (languageId >= 0) {
+                const bool pinned = pin.detected(languageId, probability);
+                char confidence[16];
+                snprintf(confidence, sizeof(confidence), "%.2f", probability);
+                LOG_INFO(std::string("Detected language ") + whisper_lang_str(languageId) + " (p=" + confidence + ")"
+                         + (pinned ? ", pinned" : ""));
+            }
+        }
+        if (languageId >= 0) {
+            language = whisper_lang_str(languageId);
+            wparams.language = language.c_str();
+        }
+    }
+
+    DiarizationTask diarization;
+    if (diarize) {
+        SpeakerDiarizer* diarizer = diarizer_.get();
+        diarization.control = control;
+        if (control) control->setDiarizing(true);
+        diarization.future = std::async(std::launch::async, [diarizer, samples, numSamples, sampleRate,
+                                                             control, abandoned = diarization.abandoned]() {
+            SpeakerDiarizer::ProgressCallback progress = [control, abandoned](int processed, int total) {
+                if (control) control->setDiarizationProgress(total > 0 ? processed * 100 / total : 0);
+                return !*abandoned && !(control && control->isCancelled());
+            };
+            return diarizer->process(samples, static_cast<int>(numSamples), sampleRate, progress);
+        });
+    }
+
+    // Long recordings are cut at silences and the chunks decoded in parallel
+    const int chunkWorkers = snapshot.chunkWorkers;
+    const size_t minChunkedSamples = static_cast<size_t>(2 * kMinChunkSeconds) * static_cast<size_t>(sampleRate);
+    TranscriptResult result;
+    if (longFileChunking && chunkWorkers > 1 && inputSamples >= minChunkedSamples) {
+        result = transcribeChunked(*model, input, inputSamples, sampleRate, wparams, chunkWorkers, control);
+    } else {
+        whisper_context* ctx = model->context();
+        const int64_t inputCs = static_cast<int64_t>(inputSamples) * 100 / sampleRate;
+
+        // A clip that fits one encoder window and was decoded recently still has its
+        // encoding in a retained state: another language or task only needs the
+        // decoder. The Accurate preset always gets a full beam-search run.
+        const bool reusable = encoderCache_->getCapacity() > 0 && whisper_is_multilingual(ctx)
+                              && preset != DecodingPresets::Preset::Accurate
+                              && inputSamples <= static_cast<size_t>(30 * sampleRate);
+        const int requestedLanguage = language == "auto" ? -1 : whisper_lang_id(language.c_str());
+        uint64_t audioHash = 0;
+        bool decoded = false;
+        if (reusable) {
+            audioHash = ResultCache::hashBytes(input, inputSamples * sizeof(float));
+            EncoderCache::Entry retained;
+            if (encoderCache_->take(model.get(), audioHash, inputSamples, retained)) {
+                // Auto mode keeps the language detected on the first pass
+                const int languageId = requestedLanguage >= 0 ? requestedLanguage : retained.languageId;
+                if (languageId >= 0 && (languageId != retained.languageId || translate != retained.translate)) {
+                    const auto start = std::chrono::steady_clock::now();
+                    TranscriptResult redecoded = decodeRetained(*model, retained.state, languageId, translate,
+                                                                whisperThreads, inputCs, control);
+                    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    if (redecoded.ok()) {
+                        LOG_INFO(std::string("Re-decoded retained encoding as ") + whisper_lang_str(languageId)
+                                 + (translate ? " -> en" : "") + " in " + std::to_string(static_cast<int>(ms))
+                                 + " ms (mel and encoder skipped)");
+                        retained.languageId = languageId;
+                        retained.translate = translate;
+                        result = std::move(redecoded);
+                        decoded = true;
+                    } else if (redecoded.getError() != kCancelledError) {
+                        LOG_WARNING("Re-decoding retained encoding failed (" + redecoded.getError() + "), running whisper_full");
+                    }
                 }
+                encoderCache_->put(std::move(retained));
+            }
+        }
+        if (!decoded) {
+            // Blocks while all states are busy with other jobs
+            WhisperStatePool::Lease state = model->states().acquire();
+            if (!state) {
+                return TranscriptResult::failure("Error: Could not allocate whisper state.");
+            }
+            if (control && control->isCancelled()) {
+                return TranscriptResult::failure(kCancelledError);
             }
-            
-            // If no match found at midpoint, use the closest segment
-            if (currentSpeaker == -1) {
-                float minDist = std::numeric_limits<float>::max();
-                for (const auto& seg : diarizationSegments) {
-                    float dist = std::min(std::abs(segmentMid - seg.start), 
-                                          std::abs(segmentMid - seg.end));
-                    if (dist < minDist) {
-                        minDist = dist;
-                        currentSpeaker = seg.speaker;
+            // Encoder runs of the last whisper_full; after exactly one, the state
+            // holds the encoding of the whole clip and can be retained
+            int encodes = 0;
+            wparams.encoder_begin_callback = [](whisper_context*, whisper_state*, void* data) {
+                ++*static_cast<int*>(data);
+                return true;
+            };
+            wparams.encoder_begin_callback_user_data = &encodes;
+            // Short clips don't need the encoder to process 30 s of padding. The
+            // Accurate preset always gets the full window.
+            const int fullCtx = whisper_n_audio_ctx(ctx);
+            const int audioCtx = adaptiveAudioContext && preset != DecodingPresets::Preset::Accurate
+                                     ? adaptiveAudioCtx(inputSamples, sampleRate, fullCtx) : 0;
+            if (audioCtx > 0) {
+                whisper_full_params reduced = wparams;
+                reduced.audio_ctx = audioCtx;
+                const auto start = std::chrono::steady_clock::now();
+                result = runWhisper(*model, state.get(), reduced, input, inputSamples);
+                const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                // Quality guard: a shortened context can lose speech at the end or garble it
+                std::string retryReason;
+                if (result.ok() && !(control && control->isCancelled())) {
+                    if (result.empty()) {
+                        retryReason = "no text";
+                    } else if (meanTokenProbability(result) < kAdaptiveCtxMinTokenProbability) {
+                        retryReason = "low token confidence";
+                    } else {
+                        const std::vector<VoiceActivity::Region> regions = VoiceActivity::detect(input, inputSamples, sampleRate);
+                        const int64_t speechEndCs = regions.empty() ? 0 : static_cast<int64_t>(regions.back().end) * 100 / sampleRate;
+                        const int64_t textEndCs = result.segment(result.segmentCount() - 1).t1;
+                        if (speechEndCs - textEndCs > static_cast<int64_t>(kAdaptiveCtxMissedSpeechSeconds * 100.0f)) {
+                            retryReason = "speech after the last segment";
+                        }
                     }
                 }
+                if (!retryReason.empty()) {
+                    LOG_INFO("audio_ctx " + std::to_string(audioCtx) + " result rejected (" + retryReason
+                             + "), retrying with full context");
+                    encodes = 0;
+                    state.setReducedContext(true);
+                    result = runWhisper(*model, state.get(), wparams, input, inputSamples);
+                    // Anything decoded means whisper_full got as far as setting the context
+                    if (!result.empty()) state.setReducedContext(false);
+                } else {
+                    state.setReducedContext(true);
+                    if (result.ok()) {
+                        char speedup[16];
+                        snprintf(speedup, sizeof(speedup), "%.1f", static_cast<double>(fullCtx) / audioCtx);
+                        LOG_INFO("audio_ctx " + std::to_string(fullCtx) + " -> " + std::to_string(audioCtx) + " for "
+                                 + std::to_string(inputSamples * 1000 / sampleRate) + " ms clip (~" + speedup
+                                 + "x less encoder work), decoded in " + std::to_string(static_cast<int>(ms)) + " ms");
+                    }
+                }
+            } else {
+                result = runWhisper(*model, state.get(), wparams, input, inputSamples);
+                if (!result.empty()) state.setReducedContext(false);
             }
-            
-            // Add speaker label if speaker changed
-            if (currentSpeaker != lastSpeaker && currentSpeaker >= 0) {
-                if (i > 0) result += "\n";
-                result += "Speaker " + std::to_string(currentSpeaker + 1) + ": ";
-                lastSpeaker = currentSpeaker;
+
+            if (reusable && encodes == 1 && result.ok() && !(control && control->isCancelled())) {
+                EncoderCache::Entry retained;
+                retained.model = model;
+                retained.owner = model.get();
+                retained.audioHash = audioHash;
+                retained.numSamples = inputSamples;
+                retained.languageId = requestedLanguage >= 0 ? requestedLanguage : whisper_full_lang_id_from_state(state.get());
+                retained.translate = translate;
+                retained.state = state.detach();
+                encoderCache_->put(std::move(retained));
             }
         }
-        
-        if (printTimestamps_) {
-            char timestamp[32];
-            snprintf(timestamp, sizeof(timestamp), "[%02d:%02d.%03d --> %02d:%02d.%03d] ",
-                     (int)(t0 / 100 / 60), (int)(t0 / 100 % 60), (int)(t0 % 100) * 10,
-                     (int)(t1 / 100 / 60), (int)(t1 / 100 % 60), (int)(t1 % 100) * 10);
-            result += timestamp;
+    }
+    if (control && control->isCancelled()) {
+        return TranscriptResult::failure(kCancelledError);
+    }
+    if (!result.ok()) {
+        return result;
+    }
+    if (pinnedLanguage >= 0 && !result.empty() && pin.decoded(pinnedLanguage, meanTokenProbability(result))) {
+        LOG_INFO(std::string("Low confidence in pinned language ") + whisper_lang_str(pinnedLanguage)
+                 + ", detecting again on the next clip");
+    }
+    if (compacted) {
+        result.mapTimes([&speech](int64_t cs) { return speech.toOriginalCs(cs); });
+    }
+    result.setDuration(static_cast<int64_t>(numSamples) * 100 / sampleRate);
+
+    if (diarization.future.valid()) {
+        const std::vector<SpeakerSegment> diarizationSegments = diarization.future.get();
+        if (control) {
+            control->setDiarizing(false);
+            if (control->isCancelled()) {
+                return TranscriptResult::failure(kCancelledError);
+            }
+        }
+        if (!diarizationSegments.empty()) {
+            SpeakerAlignment::assignSpeakers(result, diarizationSegments);
         }
-        result += text;
-        if (i < n_segments - 1) result += "\n";
     }
 
     return result;
 }
 
-bool WhisperEngine::readWav(const std::string& wavPath, std::vector<float>& pcmf32, int& sampleRate, int& channels) {
-    std::ifstream file(wavPath, std::ios::binary);
-    if (!file.is_open()) return false;
+int WhisperEngine::detectLanguage(WhisperModel& model, whisper_state* state, const float* samples, size_t numSamples,
+                                  int nThreads, float& probability) {
+    whisper_context* ctx = model.context();
+    const int n = static_cast<int>(std::min<size_t>(numSamples, 30 * 16000));
+    probability = 0.0f;
+    if (whisper_pcm_to_mel_with_state(ctx, state, samples, n, nThreads) != 0) {
+        return -1;
+    }
+    std::vector<float> probabilities(static_cast<size_t>(whisper_lang_max_id()) + 1, 0.0f);
+    const int languageId = whisper_lang_auto_detect_with_state(ctx, state, 0, nThreads, probabilities.data());
+    if (languageId >= 0) {
+        probability = probabilities[static_cast<size_t>(languageId)];
+    }
+    return languageId;
+}
+
+int WhisperEngine::adaptiveAudioCtx(size_t numSamples, int sampleRate, int fullCtx) {
+    if (sampleRate <= 0 || fullCtx <= 0) return 0;
+    const float seconds = static_cast<float>(numSamples) / static_cast<float>(sampleRate);
+    if (seconds > kAdaptiveCtxMaxSeconds) return 0;
 
-    char riffHeader[12];
-    file.read(riffHeader, sizeof(riffHeader));
-    if (file.gcount() < static_cast<std::streamsize>(sizeof(riffHeader))) return false;
+    // Encoder frames are 20 ms; 64-frame steps keep the matrix shapes kernel-friendly
+    const float covered = std::max(seconds + kAdaptiveCtxMarginSeconds, kAdaptiveCtxMinSeconds);
+    const int frames = static_cast<int>(std::ceil(covered * 50.0f));
+    const int audioCtx = (frames + 63) / 64 * 64;
+    return audioCtx < fullCtx ? audioCtx : 0;
+}
+
+TranscriptResult WhisperEngine::runWhisper(WhisperModel& model, whisper_state* state, const whisper_full_params& wparams,
+                                           const float* samples, size_t numSamples) {
+    whisper_context* ctx = model.context();
+    if (whisper_full_with_state(ctx, state, wparams, samples, static_cast<int>(numSamples)) != 0) {
+        return TranscriptResult::failure("Error: Transcription failed.");
+    }
 
-    if (std::strncmp(riffHeader, "RIFF", 4) != 0) return false;
-    if (std::strncmp(riffHeader + 8, "WAVE", 4) != 0) return false;
+    TranscriptResult result;
+    const int n_segments = whisper_full_n_segments_from_state(state);
+    const whisper_token tokenEot = whisper_token_eot(ctx);
 
-    bool foundFmt = false;
-    bool foundData = false;
-    uint16_t bitsPerSample = 0;
-    uint32_t dataSize = 0;
-    std::streampos dataOffset = 0;
+    for (int i = 0; i < n_segments; ++i) {
+        const char* text = whisper_full_get_segment_text_from_state(state, i);
+        const int64_t t0 = whisper_full_get_segment_t0_from_state(state, i);
+        const int64_t t1 = whisper_full_get_segment_t1_from_state(state, i);
+        
+        result.addSegment(t0, t1, text);
 
-    while (file && (!foundFmt || !foundData)) {
-        char chunkId[4];
-        uint32_t chunkSize = 0;
+        // Text tokens only; special and timestamp tokens carry no text
+        const int n_tokens = whisper_full_n_tokens_from_state(state, i);
+        for (int k = 0; k < n_tokens; ++k) {
+            const whisper_token_data data = whisper_full_get_token_data_from_state(state, i, k);
+            if (data.id >= tokenEot) continue;
+            result.addToken(data.id, data.t0, data.t1, data.p,
+                            whisper_full_get_token_text_from_state(ctx, state, i, k));
+        }
+    }
+    return result;
+}
 
-        file.read(chunkId, sizeof(chunkId));
-        if (file.gcount() < static_cast<std::streamsize>(sizeof(chunkId))) break;
-        file.read(reinterpret_cast<char*>(&chunkSize), sizeof(chunkSize));
-        if (file.gcount() < static_cast<std::streamsize>(sizeof(chunkSize))) break;
+// =============================================================================
+// RE-DECODING A RETAINED ENCODING
+// =============================================================================
+// whisper_full always computes the mel and runs the encoder, which is most of
+// the cost of a short clip on CPU. After a single-window run the encoder output
+// is still in the state's cross-attention cache, so the text decoder can be
+// driven directly through whisper_decode_with_state with a new prompt.
 
-        if (std::strncmp(chunkId, "fmt ", 4) == 0) {
-            uint16_t audioFormat = 0;
-            uint16_t channelsRaw = 0;
-            uint32_t sampleRateRaw = 0;
+TranscriptResult WhisperEngine::decodeRetained(WhisperModel& model, whisper_state* state, int languageId, bool translate,
+                                               int nThreads, int64_t durationCs, JobControl* control) {
+    whisper_context* ctx = model.context();
+    const int nVocab = whisper_n_vocab(ctx);
+    const whisper_token tokenEot = whisper_token_eot(ctx);
+    const whisper_token tokenBeg = whisper_token_beg(ctx);
+    // Timestamp tokens are 20 ms apart; none past the end of the clip, the first within 1 s
+    const whisper_token lastTimestamp = tokenBeg + static_cast<whisper_token>(std::min<int64_t>(durationCs / 2, 1500));
+    const whisper_token maxInitialTimestamp = tokenBeg + 50;
 
-            file.read(reinterpret_cast<char*>(&audioFormat), sizeof(audioFormat));
-            file.read(reinterpret_cast<char*>(&channelsRaw), sizeof(channelsRaw));
-            file.read(reinterpret_cast<char*>(&sampleRateRaw), sizeof(sampleRateRaw));
+    std::vector<whisper_token> tokens = {
+        whisper_token_sot(ctx),
+        whisper_token_lang(ctx, languageId),
+        translate ? whisper_token_translate(ctx) : whisper_token_transcribe(ctx)
+    };
+    const size_t promptLength = tokens.size();
+    const size_t maxTokens = static_cast<size_t>(whisper_n_text_ctx(ctx) / 2);
+    std::vector<float> probabilities; // Of each generated token
+    std::vector<float> logits(static_cast<size_t>(nVocab));
+    const float negInf = -std::numeric_limits<float>::infinity();
 
-            if (!file) return false;
+    int past = 0;
+    for (;;) {
+        if (control && control->isCancelled()) {
+            return TranscriptResult::failure(kCancelledError);
+        }
+        const int batch = static_cast<int>(tokens.size()) - past;
+        if (whisper_decode_with_state(ctx, state, tokens.data() + past, batch, past, nThreads) != 0) {
+            return TranscriptResult::failure("Error: Decoding failed.");
+        }
+        past += batch;
+        const float* row = whisper_get_logits_from_state(state) + static_cast<size_t>(batch - 1) * nVocab;
+        logits.assign(row, row + nVocab);
 
-            channels = channelsRaw;
-            sampleRate = sampleRateRaw;
+        // Special tokens other than end-of-text never appear in the output
+        for (whisper_token id = tokenEot + 1; id < tokenBeg; ++id) logits[id] = negInf;
+        for (whisper_token id = lastTimestamp + 1; id < nVocab; ++id) logits[id] = negInf;
 
-            file.seekg(6, std::ios::cur); // byteRate (4) + blockAlign (2)
-            file.read(reinterpret_cast<char*>(&bitsPerSample), sizeof(bitsPerSample));
-            if (!file) return false;
+        // Timestamp rules: text opens with a timestamp, timestamps come in
+        // (end, start) pairs between segments, and never go backwards
+        const size_t generated = tokens.size() - promptLength;
+        if (generated == 0) {
+            for (whisper_token id = 0; id < tokenBeg; ++id) logits[id] = negInf;
+            for (whisper_token id = maxInitialTimestamp + 1; id < nVocab; ++id) logits[id] = negInf;
+        } else {
+            const bool lastWasTimestamp = tokens.back() >= tokenBeg;
+            const bool penultimateWasTimestamp = generated < 2 || tokens[tokens.size() - 2] >= tokenBeg;
+            if (lastWasTimestamp && penultimateWasTimestamp) {
+                for (whisper_token id = tokenBeg; id < nVocab; ++id) logits[id] = negInf;
+            } else if (lastWasTimestamp) {
+                for (whisper_token id = 0; id < tokenEot; ++id) logits[id] = negInf;
+            }
+            whisper_token previous = tokenBeg;
+            for (size_t i = promptLength; i < tokens.size(); ++i) {
+                if (tokens[i] >= tokenBeg) previous = tokens[i];
+            }
+            const whisper_token minTimestamp = lastWasTimestamp && !penultimateWasTimestamp ? previous : previous + 1;
+            for (whisper_token id = tokenBeg; id < std::min(minTimestamp, nVocab); ++id) logits[id] = negInf;
+        }
 
-            if (chunkSize > 16) {
-                file.seekg(chunkSize - 16, std::ios::cur);
+        // Softmax; a timestamp is forced when timestamps together outweigh the best text token
+        float maxLogit = negInf;
+        for (float logit : logits) maxLogit = std::max(maxLogit, logit);
+        double sum = 0.0;
+        double timestampSum = 0.0;
+        float maxText = 0.0f;
+        for (whisper_token id = 0; id < nVocab; ++id) {
+            const float p = std::exp(logits[id] - maxLogit);
+            sum += p;
+            if (id >= tokenBeg) {
+                timestampSum += p;
+            } else {
+                maxText = std::max(maxText, p);
             }
-            foundFmt = true;
-        } else if (std::strncmp(chunkId, "data", 4) == 0) {
-            dataSize = chunkSize;
-            dataOffset = file.tellg();
-            file.seekg(chunkSize, std::ios::cur);
-            foundData = true;
+        }
+        if (timestampSum > maxText) {
+            for (whisper_token id = 0; id < tokenBeg; ++id) logits[id] = negInf;
+        }
+        const whisper_token next = static_cast<whisper_token>(std::max_element(logits.begin(), logits.end()) - logits.begin());
+        if (logits[next] == negInf) {
+            return TranscriptResult::failure("Error: Decoding failed.");
+        }
+        if (next == tokenEot) break;
+        if (generated >= maxTokens) {
+            // Likely a repetition loop; whisper_full's temperature fallback handles those
+            return TranscriptResult::failure("Error: Decoder did not reach end of text.");
+        }
+        tokens.push_back(next);
+        probabilities.push_back(static_cast<float>(std::exp(logits[next] - maxLogit) / sum));
+        if (control && next >= tokenBeg && durationCs > 0) {
+            // Timestamps are in 20 ms steps
+            control->setDecodeProgress(static_cast<int>(std::min<int64_t>(99, (next - tokenBeg) * 200 / durationCs)));
+        }
+    }
+
+    // Segments run from one timestamp to the next; token times are spread
+    // evenly inside them (no cross-attention alignment on this path)
+    TranscriptResult result;
+    std::vector<size_t> pending; // Indices into tokens since the last timestamp
+    int64_t segmentStart = 0;
+    auto flush = [&](int64_t segmentEnd) {
+        if (pending.empty()) return;
+        segmentEnd = std::max(segmentEnd, segmentStart);
+        std::string text;
+        for (size_t i : pending) text += whisper_token_to_str(ctx, tokens[i]);
+        result.addSegment(segmentStart, segmentEnd, text);
+        const int64_t span = segmentEnd - segmentStart;
+        const int64_t count = static_cast<int64_t>(pending.size());
+        for (int64_t k = 0; k < count; ++k) {
+            const size_t i = pending[static_cast<size_t>(k)];
+            result.addToken(tokens[i], segmentStart + span * k / count, segmentStart + span * (k + 1) / count,
+                            probabilities[i - promptLength], whisper_token_to_str(ctx, tokens[i]));
+        }
+        pending.clear();
+    };
+    for (size_t i = promptLength; i < tokens.size(); ++i) {
+        if (tokens[i] >= tokenBeg) {
+            const int64_t t = static_cast<int64_t>(tokens[i] - tokenBeg) * 2;
+            flush(t);
+            segmentStart = t;
         } else {
-            file.seekg(chunkSize, std::ios::cur);
+            pending.push_back(i);
+        }
+    }
+    flush(durationCs);
+    return result;
+}
+
+// =============================================================================
+// CHUNKED TRANSCRIPTION (long files)
+// =============================================================================
+// whisper_full walks a recording 30 s at a time, so one long file keeps a
+// single state busy no matter how many cores are idle. Instead the audio is
+// cut at silences into ~30-120 s chunks and each worker decodes chunks on
+// its own state. Chunks are decoded with a little audio from their
+// neighbours; each word is kept by the chunk that owns its midpoint, so a
+// sentence straddling a cut is assembled from both sides without duplicates.
+
+int WhisperEngine::getEffectiveChunkWorkers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (chunkWorkers_ > 0) {
+        return chunkWorkers_;
+    }
+    // Whisper scales poorly past ~4 threads per state, so spend cores on states instead
+    const int hw = CpuInfo::logicalCores();
+    return std::max(1, hw / 4);
+}
+
+void WhisperEngine::setChunkWorkers(int workers) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunkWorkers_ = std::max(0, workers);
+    }
+    updatePoolCapacity();
+}
+
+void WhisperEngine::setRetainedEncodings(int clips) {
+    encoderCache_->setCapacity(clips);
+}
+
+void WhisperEngine::setLongFileChunking(bool enable) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        longFileChunking_ = enable;
+    }
+    updatePoolCapacity();
+}
+
+int WhisperEngine::getPoolCapacity() const {
+    int capacity = getMaxConcurrentJobs();
+    bool chunking = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunking = longFileChunking_;
+    }
+    if (chunking) {
+        // One chunked job at full width plus a state for every other job slot
+        capacity += getEffectiveChunkWorkers() - 1;
+    }
+    return capacity;
+}
+
+void WhisperEngine::updatePoolCapacity() {
+    modelCache_->setPoolCapacity(getPoolCapacity());
+}
+
+TranscriptResult WhisperEngine::transcribeChunked(WhisperModel& model, const float* samples, size_t numSamples, int sampleRate,
+                                                  const whisper_full_params& wparams, int workers, JobControl* control) {
+    SilenceSplitter::Options options;
+    options.minSeconds = static_cast<float>(kMinChunkSeconds);
+    options.maxSeconds = static_cast<float>(kMaxChunkSeconds);
+    // Enough chunks that every worker gets work, but no shorter than minSeconds
+    options.targetSeconds = static_cast<float>(numSamples) / sampleRate / static_cast<float>(workers);
+    const std::vector<SilenceSplitter::Chunk> chunks = SilenceSplitter::split(samples, numSamples, sampleRate, options);
+    if (chunks.size() < 2) {
+        WhisperStatePool::Lease state = model.states().acquire();
+        if (!state) {
+            return TranscriptResult::failure("Error: Could not allocate whisper state.");
+        }
+        return runWhisper(model, state.get(), wparams, samples, numSamples);
+    }
+
+    // Every worker needs its own state. Extra states are only taken while each
+    // other concurrent job slot would still find one free, so a chunked job
+    // never makes the next job wait; it runs narrower instead.
+    std::vector<WhisperStatePool::Lease> states;
+    states.push_back(model.states().acquire());
+    if (!states.front()) {
+        return TranscriptResult::failure("Error: Could not allocate whisper state.");
+    }
+    const int keepFree = std::max(0, getMaxConcurrentJobs() - 1);
+    workers = std::min(workers, static_cast<int>(chunks.size()));
+    while (static_cast<int>(states.size()) < workers) {
+        WhisperStatePool::Lease extra = model.states().tryAcquire(keepFree);
+        if (!extra) break;
+        states.push_back(std::move(extra));
+    }
+    workers = static_cast<int>(states.size());
+    whisper_full_params chunkParams = wparams;
+    const int hw = CpuInfo::logicalCores();
+    chunkParams.n_threads = std::max(1, std::min(wparams.n_threads, hw / workers));
+
+    LOG_INFO("Transcribing " + std::to_string(chunks.size()) + " chunks on " + std::to_string(workers)
+             + " workers (" + std::to_string(chunkParams.n_threads) + " threads each)");
+    const auto started = std::chrono::steady_clock::now();
+
+    const size_t padding = static_cast<size_t>(kChunkPaddingSeconds * sampleRate);
+    std::vector<TranscriptResult> results(chunks.size());
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<bool> failed{false};
+
+    // Job progress is the chunks' progress weighted by their length
+    struct ChunkProgress {
+        JobControl* control;
+        std::mutex* mutex;
+        std::vector<int>* percent;
+        const std::vector<SilenceSplitter::Chunk>* chunks;
+        size_t total;
+        size_t chunk;
+    };
+    std::mutex progressMutex;
+    std::vector<int> chunkPercent(chunks.size(), 0);
+    auto reportProgress = [](whisper_context*, whisper_state*, int progress, void* data) {
+        ChunkProgress* p = static_cast<ChunkProgress*>(data);
+        std::lock_guard<std::mutex> lock(*p->mutex);
+        (*p->percent)[p->chunk] = progress;
+        double done = 0.0;
+        for (size_t i = 0; i < p->chunks->size(); ++i) {
+            done += static_cast<double>((*p->chunks)[i].end - (*p->chunks)[i].start) * (*p->percent)[i] / 100.0;
+        }
+        p->control->setDecodeProgress(static_cast<int>(100.0 * done / static_cast<double>(p->total)));
+    };
+
+    auto worker = [&](whisper_state* state) {
+        ChunkProgress progress{control, &progressMutex, &chunkPercent, &chunks, std::max<size_t>(1, numSamples), 0};
+        whisper_full_params params = chunkParams;
+        if (control) {
+            params.progress_callback = reportProgress;
+            params.progress_callback_user_data = &progress;
+        }
+        for (size_t i = nextChunk++; i < chunks.size() && !failed; i = nextChunk++) {
+            if (control && control->isCancelled()) {
+                failed = true;
+                break;
+            }
+            const size_t begin = chunks[i].start > padding ? chunks[i].start - padding : 0;
+            const size_t end = std::min(numSamples, chunks[i].end + padding);
+            progress.chunk = i;
+            results[i] = runWhisper(model, state, params, samples + begin, end - begin);
+            if (!results[i].ok()) {
+                failed = true;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(workers) - 1);
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(worker, states[static_cast<size_t>(w)].get());
+    }
+    worker(states.front().get());
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (failed) {
+        if (control && control->isCancelled()) {
+            return TranscriptResult::failure(kCancelledError);
+        }
+        for (const TranscriptResult& chunkResult : results) {
+            if (!chunkResult.ok()) return chunkResult;
+        }
+        return TranscriptResult::failure("Error: Transcription failed.");
+    }
+
+    // Stitch: shift each chunk to file time and keep the words whose midpoint it
+    // owns. A segment cut by the owned range keeps only its owned words.
+    TranscriptResult stitched;
+    std::vector<size_t> kept; // Token indices of the current segment
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const size_t begin = chunks[i].start > padding ? chunks[i].start - padding : 0;
+        const int64_t offset = static_cast<int64_t>(begin) * 100 / sampleRate;
+        const int64_t ownedFrom = i > 0 ? static_cast<int64_t>(chunks[i].start) * 100 / sampleRate
+                                        : std::numeric_limits<int64_t>::min();
+        const int64_t ownedTo = i + 1 < chunks.size() ? static_cast<int64_t>(chunks[i].end) * 100 / sampleRate
+                                                      : std::numeric_limits<int64_t>::max();
+        auto owned = [&](int64_t t0, int64_t t1) {
+            const int64_t mid = (t0 + t1) / 2 + offset;
+            return mid >= ownedFrom && mid < ownedTo;
+        };
+        const TranscriptResult& chunkResult = results[i];
+        const std::vector<TranscriptResult::Token>& tokens = chunkResult.getTokens();
+
+        for (size_t k = 0; k < chunkResult.segmentCount(); ++k) {
+            const TranscriptResult::Segment& segment = chunkResult.segment(k);
+            if (segment.tokenCount == 0) {
+                if (owned(segment.t0, segment.t1)) {
+                    stitched.addSegment(segment.t0 + offset, segment.t1 + offset, chunkResult.segmentText(k));
+                }
+                continue;
+            }
+
+            // Words as TranscriptResult groups them
+            kept.clear();
+            size_t wordBegin = segment.firstToken;
+            const size_t segmentEnd = segment.firstToken + segment.tokenCount;
+            for (size_t n = segment.firstToken + 1; n <= segmentEnd; ++n) {
+                if (n < segmentEnd) {
+                    const std::string_view text = chunkResult.tokenText(tokens[n]);
+                    if (!TranscriptResult::opensWord(text)) continue;
+                }
+                int64_t t1 = tokens[wordBegin].t1;
+                for (size_t w = wordBegin; w < n; ++w) t1 = std::max(t1, tokens[w].t1);
+                if (owned(tokens[wordBegin].t0, t1)) {
+                    for (size_t w = wordBegin; w < n; ++w) kept.push_back(w);
+                }
+                wordBegin = n;
+            }
+            if (kept.empty()) continue;
+
+            if (kept.size() == segment.tokenCount) {
+                stitched.addSegment(segment.t0 + offset, segment.t1 + offset, chunkResult.segmentText(k));
+            } else {
+                // Trimmed at a cut: the text and times of the owned words only
+                std::string text;
+                int64_t t0 = tokens[kept.front()].t0;
+                int64_t t1 = tokens[kept.front()].t1;
+                for (size_t n : kept) {
+                    text += chunkResult.tokenText(tokens[n]);
+                    t0 = std::min(t0, tokens[n].t0);
+                    t1 = std::max(t1, tokens[n].t1);
+                }
+                t0 = std::max(t0, segment.t0);
+                t1 = std::max(t0, std::min(t1, segment.t1));
+                stitched.addSegment(t0 + offset, t1 + offset, text);
+            }
+            for (size_t n : kept) {
+                const TranscriptResult::Token& token = tokens[n];
+                stitched.addToken(token.id, token.t0 + offset, token.t1 + offset, token.p, chunkResult.tokenText(token));
+            }
         }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    LOG_INFO("Chunked transcription of " + std::to_string(numSamples / sampleRate) + " s took "
+             + std::to_string(seconds) + " s");
+    return stitched;
+}
+
+// =============================================================================
+// THREAD CALIBRATION
+// =============================================================================
+// The best thread count depends on the model size, the CPU's cache and SMT
+// layout and its memory bandwidth, so it's measured rather than guessed.
 
-        if (chunkSize % 2 == 1) {
-            file.seekg(1, std::ios::cur); // pad byte
+namespace {
+    // Voiced-speech-like test signal: a harmonic series with a syllable-rate envelope
+    std::vector<float> makeCalibrationClip(float seconds) {
+        std::vector<float> clip(static_cast<size_t>(seconds * 16000.0f));
+        for (size_t i = 0; i < clip.size(); ++i) {
+            const double t = static_cast<double>(i) / 16000.0;
+            const double f0 = 120.0 + 30.0 * std::sin(2.0 * 3.14159265 * 0.5 * t);
+            const double envelope = 0.5 + 0.5 * std::sin(2.0 * 3.14159265 * 4.0 * t);
+            double v = 0.0;
+            for (int h = 1; h <= 10; ++h) v += std::sin(2.0 * 3.14159265 * f0 * h * t) / h;
+            clip[i] = static_cast<float>(0.1 * envelope * v);
         }
+        return clip;
     }
 
-    if (!foundFmt || !foundData) return false;
-    if (bitsPerSample != 16) return false;
-    if (channels != 1 && channels != 2) return false;
+    // Descending, deduplicated, at least 1
+    std::vector<int> threadCandidates(std::vector<int> counts) {
+        for (int& count : counts) count = std::max(1, count);
+        std::sort(counts.begin(), counts.end(), std::greater<int>());
+        counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+        return counts;
+    }
+}
 
-    const uint32_t bytesPerFrame = static_cast<uint32_t>(channels * (bitsPerSample / 8));
-    if (bytesPerFrame == 0) return false;
+WhisperEngine::ThreadCalibration WhisperEngine::calibrateThreads() {
+    ThreadCalibration calibration;
+    const int physical = CpuInfo::physicalCores();
+    const int logical = CpuInfo::logicalCores();
+    LOG_INFO("Calibrating threads (" + std::to_string(physical) + " physical cores, "
+             + std::to_string(logical) + " logical)");
 
-    const size_t numFrames = static_cast<size_t>(dataSize / bytesPerFrame);
-    const size_t maxFrames = 100'000'000; // avoid excessive memory use
-    if (numFrames == 0 || numFrames > maxFrames) return false;
+    std::string modelName;
+    {
+        std::shared_ptr<WhisperModel> model = currentModel();
+        if (!model) {
+            LOG_WARNING("Thread calibration skipped: no model loaded");
+            return calibration;
+        }
+        modelName = model->getName();
 
-    pcmf32.resize(numFrames);
+        WhisperStatePool::Lease state = model->states().acquire();
+        if (!state) {
+            LOG_ERROR("Thread calibration failed: could not allocate whisper state");
+            return calibration;
+        }
 
-    file.clear();
-    file.seekg(dataOffset, std::ios::beg);
+        // The encoder always runs a full 30 s window, so a short clip is representative;
+        // decoding is capped so a hallucinating model can't skew the timings
+        const std::vector<float> clip = makeCalibrationClip(3.0f);
+        whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+        wparams.print_progress = false;
+        wparams.print_special = false;
+        wparams.print_realtime = false;
+        wparams.print_timestamps = false;
+        wparams.language = "en";
+        wparams.no_context = true;
+        wparams.single_segment = true;
+        wparams.max_tokens = 16;
 
-    std::vector<int16_t> buffer(4096 * channels);
-    size_t framesReadTotal = 0;
+        auto timeRun = [&](int threads) {
+            wparams.n_threads = threads;
+            const auto start = std::chrono::steady_clock::now();
+            if (whisper_full_with_state(model->context(), state.get(), wparams, clip.data(), static_cast<int>(clip.size())) != 0) {
+                return -1.0;
+            }
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        timeRun(physical); // Warm-up: first run allocates buffers and faults in the weights
+        for (int threads : threadCandidates({physical, logical, physical * 3 / 4, physical / 2})) {
+            const double ms = std::min(timeRun(threads), timeRun(threads));
+            if (ms < 0.0) continue;
+            LOG_INFO("  whisper, " + std::to_string(threads) + " threads: " + std::to_string(static_cast<int>(ms)) + " ms");
+            if (calibration.whisperThreads == 0 || ms < calibration.whisperMs) {
+                calibration.whisperThreads = threads;
+                calibration.whisperMs = ms;
+            }
+        }
+    }
+
+    if (diarizer_ && diarizer_->isInitialized()) {
+        // Segmentation works on 10 s windows, so give it at least one full window
+        const std::vector<float> clip = makeCalibrationClip(12.0f);
+        const std::string segmentationModel = diarizer_->getSegmentationModel();
+        const std::string embeddingModel = diarizer_->getEmbeddingModel();
+        double bestMs = 0.0;
+        for (int threads : threadCandidates({1, 2, 4, physical / 2})) {
+            if (threads > std::max(1, physical / 2)) continue;
+            // A private pipeline on the same models, built at this thread count up
+            // front: the shared diarizer stays free for jobs and keeps its threads
+            SpeakerDiarizer probe;
+            probe.setNumThreads(threads);
+            if (!probe.initialize(segmentationModel, embeddingModel)) break;
+            const auto start = std::chrono::steady_clock::now();
+            probe.process(clip.data(), static_cast<int>(clip.size()), 16000);
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO("  diarization, " + std::to_string(threads) + " threads: " + std::to_string(static_cast<int>(ms)) + " ms");
+            if (calibration.diarizationThreads == 0 || ms < bestMs) {
+                calibration.diarizationThreads = threads;
+                bestMs = ms;
+            }
+        }
+    }
+
+    if (calibration.whisperThreads > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        calibrations_[modelName] = calibration;
+        LOG_INFO("Calibrated " + modelName + ": " + std::to_string(calibration.whisperThreads) + " whisper threads, "
+                 + std::to_string(calibration.diarizationThreads) + " diarization threads");
+    }
+    updateDiarizationThreads();
+    return calibration;
+}
+
+std::vector<WhisperEngine::PresetBenchmark> WhisperEngine::benchmarkDecodingPresets() {
+    std::vector<PresetBenchmark> benchmarks;
+    std::shared_ptr<WhisperModel> model = currentModel();
+    if (!model) {
+        LOG_WARNING("Decoding benchmark skipped: no model loaded");
+        return benchmarks;
+    }
+
+    std::vector<float> clip;
+    int sampleRate = 0;
+    int channels = 0;
+    if (!WavReader::readFile(DecodingPresets::kReferenceClip, clip, sampleRate, channels, 16000) || sampleRate != 16000) {
+        LOG_ERROR(std::string("Decoding benchmark failed: could not read ") + DecodingPresets::kReferenceClip);
+        return benchmarks;
+    }
+    WhisperStatePool::Lease state = model->states().acquire();
+    if (!state) {
+        LOG_ERROR("Decoding benchmark failed: could not allocate whisper state");
+        return benchmarks;
+    }
 
-    while (framesReadTotal < numFrames && file) {
-        const size_t framesRemaining = numFrames - framesReadTotal;
-        const size_t framesToRead = std::min(framesRemaining, buffer.size() / channels);
-        const size_t bytesToRead = framesToRead * bytesPerFrame;
+    const double clipMs = 1000.0 * static_cast<double>(clip.size()) / sampleRate;
+    const int threads = threadsPerJobFor(model->getName());
+    LOG_INFO("Benchmarking decoding presets on " + model->getName() + " (" + std::to_string(threads) + " threads)");
+    for (int i = 0; i < DecodingPresets::kCount; ++i) {
+        const auto preset = static_cast<DecodingPresets::Preset>(i);
+        whisper_full_params wparams = DecodingPresets::params(preset, static_cast<float>(clipMs / 1000.0));
+        wparams.print_progress = false;
+        wparams.print_special = false;
+        wparams.print_realtime = false;
+        wparams.print_timestamps = false;
+        wparams.language = "en";
+        wparams.no_context = true;
+        wparams.n_threads = threads;
 
-        file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(bytesToRead));
-        std::streamsize bytesRead = file.gcount();
-        if (bytesRead <= 0) break;
+        // Best of two, after a warm-up for the first preset
+        if (i == 0) runWhisper(*model, state.get(), wparams, clip.data(), clip.size());
+        double bestMs = 0.0;
+        std::string text;
+        for (int run = 0; run < 2; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            TranscriptResult result = runWhisper(*model, state.get(), wparams, clip.data(), clip.size());
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (!result.ok()) break;
+            if (run == 0 || ms < bestMs) bestMs = ms;
+            text = result.toText(false);
+        }
 
-        size_t framesRead = static_cast<size_t>(bytesRead) / bytesPerFrame;
-        for (size_t i = 0; i < framesRead; ++i) {
-            if (channels == 1) {
-                pcmf32[framesReadTotal + i] = static_cast<float>(buffer[i]) / 32768.0f;
+        PresetBenchmark benchmark;
+        if (bestMs > 0.0) {
+            benchmark.realTimeFactor = bestMs / clipMs;
+            benchmark.wordErrorRate = DecodingPresets::wordErrorRate(DecodingPresets::kReferenceText, text);
+        }
+        LOG_INFO(std::string("  ") + DecodingPresets::name(preset) + ": RTF " + std::to_string(benchmark.realTimeFactor)
+                 + ", WER " + std::to_string(benchmark.wordErrorRate));
+        benchmarks.push_back(benchmark);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    presetBenchmarks_[model->getName()] = benchmarks;
+    return benchmarks;
+}
+
+void WhisperEngine::setPresetBenchmarks(const std::map<std::string, std::vector<PresetBenchmark>>& benchmarks) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    presetBenchmarks_ = benchmarks;
+}
+
+std::map<std::string, std::vector<WhisperEngine::PresetBenchmark>> WhisperEngine::getPresetBenchmarks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return presetBenchmarks_;
+}
+
+void WhisperEngine::setThreadCalibrations(const std::map<std::string, ThreadCalibration>& calibrations) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        calibrations_ = calibrations;
+    }
+    updateDiarizationThreads();
+}
+
+std::map<std::string, WhisperEngine::ThreadCalibration> WhisperEngine::getThreadCalibrations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return calibrations_;
+}
+
+bool WhisperEngine::hasThreadCalibration() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return calibrations_.count(modelName_) > 0;
+}
+
+std::string WhisperEngine::getModelName() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return modelName_;
+}
+
+WhisperEngine::JobSettings WhisperEngine::snapshotSettings(const std::string& modelPath, Task task) const {
+    JobSettings settings;
+    settings.modelPath = modelPath;
+    if (settings.modelPath.empty()) {
+        std::shared_ptr<WhisperModel> model = currentModel();
+        if (model) settings.modelPath = model->getPath();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        settings.language = language_;
+        settings.translate = task == Task::Default ? translate_ : task == Task::Translate;
+        settings.printTimestamps = printTimestamps_;
+        settings.speakerDiarization = speakerDiarization_ && task != Task::Translate;
+        settings.longFileChunking = longFileChunking_;
+        settings.skipSilence = skipSilence_;
+        settings.preset = decodingPreset_;
+        settings.adaptiveAudioContext = adaptiveAudioContext_;
+    }
+    settings.chunkWorkers = getEffectiveChunkWorkers();
+    if (settings.speakerDiarization && isSpeakerDiarizationReady()) {
+        settings.numSpeakers = diarizer_->getNumSpeakers();
+        settings.diarizer = diarizer_->describe();
+    }
+    return settings;
+}
+
+std::string WhisperEngine::describeSettings(const JobSettings& settings) {
+    // Name and size tell apart re-downloaded or re-quantized files of the same name
+    std::error_code ec;
+    const uintmax_t modelSize = std::filesystem::file_size(settings.modelPath, ec);
+    std::string description = "model=" + std::filesystem::path(settings.modelPath).filename().string()
+        + ":" + std::to_string(ec ? 0 : modelSize)
+        + ";language=" + settings.language
+        + ";translate=" + (settings.translate ? "1" : "0")
+        + ";decoding=" + DecodingPresets::key(settings.preset)
+        + ";skipSilence=" + (settings.skipSilence ? "1" : "0")
+        + ";chunking=" + (settings.longFileChunking ? "1" : "0")
+        + ";adaptiveCtx=" + (settings.adaptiveAudioContext ? "1" : "0");
+    if (settings.longFileChunking) {
+        // Chunk boundaries follow from the worker count
+        description += ";chunkWorkers=" + std::to_string(settings.chunkWorkers);
+    }
+    if (settings.speakerDiarization && !settings.diarizer.empty()) {
+        description += ";speakers=" + std::to_string(settings.numSpeakers)
+                       + ";diarizer=" + settings.diarizer;
+    }
+    return description;
+}
+
+// =============================================================================
+// STREAMING TRANSCRIPTION
+// =============================================================================
+// Sliding-window decoding with local agreement: each step re-decodes all audio
+// since the last commit point, and the token prefix on which two consecutive
+// hypotheses agree is committed. Committed audio is dropped from the buffer and
+// the committed tokens become the prompt, so the window stays short.
+// =============================================================================
+
+namespace {
+    constexpr int kStreamSampleRate = 16000;
+    constexpr int kSamplesPerCentisecond = kStreamSampleRate / 100;
+    constexpr size_t kStreamMinSamples = kStreamSampleRate / 2;  // Don't decode less than 0.5 s
+    constexpr size_t kStreamMaxPromptTokens = 128;
+}
+
+void WhisperEngine::streamBegin(const StreamConfig& config) {
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    stream_ = StreamState();
+    stream_.config = config;
+    LOG_INFO("Streaming transcription started (window " + std::to_string(config.windowSeconds) +
+             "s, step " + std::to_string(config.stepSeconds) + "s)");
+}
+
+WhisperEngine::StreamUpdate WhisperEngine::streamProcess(const float* samples, size_t numSamples, bool flush) {
+    std::lock_guard<std::mutex> streamLock(streamMutex_);
+    StreamState& st = stream_;
+    StreamUpdate update;
+
+    st.audio.insert(st.audio.end(), samples, samples + numSamples);
+
+    auto partialText = [&st]() {
+        std::string text;
+        for (const auto& token : st.previous) {
+            text += token.text;
+        }
+        return text;
+    };
+
+    if (st.audio.size() < kStreamMinSamples && !flush) {
+        update.partial = partialText();
+        return update;
+    }
+
+    // A silent window would only produce hallucinations; drop it
+    float peak = 0.0f;
+    for (float sample : st.audio) {
+        peak = std::max(peak, std::abs(sample));
+    }
+    if (peak < st.config.silenceThreshold) {
+        if (flush) {
+            for (const auto& token : st.previous) {
+                update.committed += token.text;
+            }
+        }
+        st.audio.clear();
+        st.previous.clear();
+        return update;
+    }
+
+    std::vector<StreamToken> hypothesis;
+    {
+        std::shared_ptr<WhisperModel> model = modelFor(st.config.modelPath);
+        if (!model) {
+            update.error = "Error: Model not loaded.";
+            return update;
+        }
+        // Prompt tokens are only meaningful in the vocabulary they came from
+        if (st.model.lock() != model) {
+            st.promptTokens.clear();
+            st.model = model;
+        }
+        whisper_context* ctx = model->context();
+
+        std::string language;
+        bool translate = false;
+        bool adaptiveAudioContext = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            language = language_;
+            translate = translate_;
+            adaptiveAudioContext = adaptiveAudioContext_;
+        }
+
+        whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+        wparams.print_progress = false;
+        wparams.print_special = false;
+        wparams.print_realtime = false;
+        wparams.print_timestamps = false;
+        wparams.translate = translate;
+        wparams.language = (language == "auto") ? nullptr : language.c_str();
+        wparams.n_threads = threadsPerJobFor(model->getName());
+        wparams.no_context = true;        // Context comes from our own prompt tokens
+        wparams.token_timestamps = true;  // Needed to find where committed text ends in the audio
+        wparams.prompt_tokens = st.promptTokens.empty() ? nullptr : st.promptTokens.data();
+        wparams.prompt_n_tokens = static_cast<int>(st.promptTokens.size());
+        if (adaptiveAudioContext) {
+            // Windows are short; an empty hypothesis just waits for the next step
+            wparams.audio_ctx = adaptiveAudioCtx(st.audio.size(), 16000, whisper_n_audio_ctx(ctx));
+        }
+
+        // Language detection needs a state that encodes the full window
+        const bool detecting = language == "auto" && whisper_is_multilingual(ctx) && st.languagePin->get() < 0;
+        WhisperStatePool::Lease state = detecting ? model->states().acquireFullContext() : model->states().acquire();
+        if (!state) {
+            update.error = "Error: Could not allocate whisper state.";
+            return update;
+        }
+
+        // Auto-detect mode: the stream keeps the first confident detection
+        int pinnedLanguage = -1;
+        if (language == "auto" && whisper_is_multilingual(ctx)) {
+            int languageId = st.languagePin->get();
+            if (languageId >= 0) {
+                pinnedLanguage = languageId;
             } else {
-                size_t idx = i * 2;
-                float left = static_cast<float>(buffer[idx]) / 32768.0f;
-                float right = static_cast<float>(buffer[idx + 1]) / 32768.0f;
-                pcmf32[framesReadTotal + i] = (left + right) / 2.0f;
+                float probability = 0.0f;
+                languageId = detectLanguage(*model, state.get(), st.audio.data(), st.audio.size(), wparams.n_threads, probability);
+                if (st.languagePin->detected(languageId, probability)) {
+                    LOG_INFO(std::string("Streaming: pinned language ") + whisper_lang_str(languageId));
+                }
+            }
+            if (languageId >= 0) {
+                language = whisper_lang_str(languageId);
+                wparams.language = language.c_str();
+            }
+        }
+
+        if (wparams.audio_ctx > 0) state.setReducedContext(true);
+        if (whisper_full_with_state(ctx, state.get(), wparams, st.audio.data(), static_cast<int>(st.audio.size())) != 0) {
+            update.error = "Error: Transcription failed.";
+            return update;
+        }
+        if (wparams.audio_ctx == 0) {
+            // Windows are at least kStreamMinSamples, so whisper_full got as far as setting the context
+            state.setReducedContext(false);
+        }
+
+        const whisper_token eot = whisper_token_eot(ctx);
+        const int nSegments = whisper_full_n_segments_from_state(state.get());
+        double probabilitySum = 0.0;
+        for (int i = 0; i < nSegments; ++i) {
+            const int nTokens = whisper_full_n_tokens_from_state(state.get(), i);
+            for (int j = 0; j < nTokens; ++j) {
+                whisper_token_data data = whisper_full_get_token_data_from_state(state.get(), i, j);
+                if (data.id >= eot) continue; // Special and timestamp tokens
+                hypothesis.push_back({data.id, whisper_full_get_token_text_from_state(ctx, state.get(), i, j),
+                                      data.t0, data.t1});
+                probabilitySum += data.p;
+            }
+        }
+        if (pinnedLanguage >= 0 && !hypothesis.empty()
+            && st.languagePin->decoded(pinnedLanguage, static_cast<float>(probabilitySum / static_cast<double>(hypothesis.size())))) {
+            LOG_INFO("Streaming: low confidence in pinned language, detecting again");
+        }
+    }
+
+    size_t commitCount = 0;
+    size_t trimSamples = 0;
+    if (flush) {
+        commitCount = hypothesis.size();
+        trimSamples = st.audio.size();
+    } else {
+        // Local agreement: the prefix shared with the previous hypothesis is stable
+        while (commitCount < hypothesis.size() && commitCount < st.previous.size() &&
+               hypothesis[commitCount].id == st.previous[commitCount].id) {
+            ++commitCount;
+        }
+
+        // Keep the window bounded: past windowSeconds, commit everything but the last two steps
+        const int64_t durationCs = static_cast<int64_t>(st.audio.size()) / kSamplesPerCentisecond;
+        if (durationCs > static_cast<int64_t>(st.config.windowSeconds * 100.0f)) {
+            const int64_t keepFromCs = durationCs - static_cast<int64_t>(st.config.stepSeconds * 200.0f);
+            size_t forced = 0;
+            while (forced < hypothesis.size() && hypothesis[forced].t1 <= keepFromCs) {
+                ++forced;
+            }
+            if (forced > commitCount) {
+                commitCount = forced;
+            } else if (commitCount == 0) {
+                // Nothing recognisable in the old audio - drop it
+                trimSamples = static_cast<size_t>(std::max<int64_t>(0, keepFromCs)) * kSamplesPerCentisecond;
             }
         }
 
-        framesReadTotal += framesRead;
-        if (framesRead == 0) break;
+        if (commitCount > 0) {
+            // Cut at the end of the last committed token, but never into the next one
+            int64_t cutCs = hypothesis[commitCount - 1].t1;
+            if (commitCount < hypothesis.size()) {
+                cutCs = std::min(cutCs, hypothesis[commitCount].t0);
+            }
+            trimSamples = static_cast<size_t>(std::max<int64_t>(0, cutCs)) * kSamplesPerCentisecond;
+        }
     }
 
-    if (framesReadTotal != numFrames) {
-        pcmf32.resize(framesReadTotal);
+    for (size_t i = 0; i < commitCount; ++i) {
+        update.committed += hypothesis[i].text;
+        st.promptTokens.push_back(hypothesis[i].id);
+    }
+    if (st.promptTokens.size() > kStreamMaxPromptTokens) {
+        st.promptTokens.erase(st.promptTokens.begin(),
+                              st.promptTokens.end() - kStreamMaxPromptTokens);
     }
 
-    return !pcmf32.empty();
+    trimSamples = std::min(trimSamples, st.audio.size());
+    st.audio.erase(st.audio.begin(), st.audio.begin() + trimSamples);
+    st.previous.assign(hypothesis.begin() + commitCount, hypothesis.end());
+    update.partial = partialText();
+    return update;
 }
 
 // =============================================================================
@@ -304,6 +1615,7 @@ bool WhisperEngine::initializeSpeakerDiarization(const std::string& segmentation
     }
     bool result = diarizer_->initialize(segmentationModel, embeddingModel, numSpeakers);
     if (result) {
+        updateDiarizationThreads();
         LOG_INFO("Speaker diarization ready in WhisperEngine");
     } else {
         LOG_ERROR("Failed to initialize speaker diarization in WhisperEngine");
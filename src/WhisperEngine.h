@@ -3,9 +3,23 @@
 #include <vector>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include "TranscriptResult.h"
+#include "DecodingPresets.h"
+#include "LanguagePin.h"
 
 struct whisper_context;
+struct whisper_state;
+struct whisper_full_params;
 class SpeakerDiarizer;
+class WhisperModel;
+class ModelCache;
+class EncoderCache;
+class JobControl;
 
 class WhisperEngine {
 public:
@@ -13,9 +27,68 @@ public:
     ~WhisperEngine();
 
     bool loadModel(const std::string& modelPath);
-    std::string transcribe(const std::string& wavPath);
-    std::string transcribeFile(const std::string& audioPath);
-    bool isModelLoaded() const { return ctx_ != nullptr; }
+    // Load on a background thread, then run a short warm-up decode. A newer
+    // request replaces one that hasn't started yet.
+    void loadModelAsync(const std::string& modelPath);
+    enum class ModelState {
+        Unloaded,
+        Loading,
+        WarmingUp,  // Loaded and usable; first decode in progress
+        Ready,
+        Failed
+    };
+    ModelState getModelState() const;
+    static const char* modelStateName(ModelState state);
+    // Code of a whisper language id (e.g. "en"); empty if the id is unknown
+    static std::string languageCode(int languageId);
+    // Blocks while a load is in progress; returns whether a model is loaded
+    bool waitForModel();
+
+    // Models used by jobs (and the loaded one) stay resident up to this much
+    // memory, least recently used evicted first
+    void setModelCacheBudgetMB(int megabytes);
+    struct ModelCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t residentBytes = 0;
+        uint64_t budgetBytes = 0;
+        int residentModels = 0;
+    };
+    ModelCacheStats getModelCacheStats() const;
+    // Results carry segments, tokens and speakers; on failure getError() holds an "Error: ..." message
+    // modelPath picks the model for this job (from the model cache); empty uses the loaded model
+    // control (optional) receives progress and can cancel the job; a cancelled job
+    // returns kCancelledError
+    static constexpr const char* kCancelledError = "Error: Transcription cancelled.";
+    // task overrides the translate setting for one job (e.g. a second, English output of the same audio).
+    // Translate never diarizes: it's a second pass, labelled from the first (SpeakerAlignment::turnsFrom).
+    // languagePin carries the detected language between the clips of a live session, or
+    // between passes over one file, in auto-detect mode; without one, detection runs once per call
+    // settings (optional) is a snapshot taken earlier for this job, e.g. to key the result
+    // cache; it replaces modelPath and task. Without one, the settings are read at the start.
+    enum class Task {
+        Default,    // As set by setTranslate()
+        Transcribe,
+        Translate
+    };
+    struct JobSettings;
+    TranscriptResult transcribe(const std::string& wavPath, const std::string& modelPath = std::string(),
+                                JobControl* control = nullptr, Task task = Task::Default,
+                                LanguagePin* languagePin = nullptr, const JobSettings* settings = nullptr);
+    // Transcribe mono PCM already in memory (no WAV round trip). Only 16 kHz is supported.
+    TranscriptResult transcribe(const float* samples, size_t numSamples, int sampleRate = 16000,
+                                const std::string& modelPath = std::string(), JobControl* control = nullptr,
+                                Task task = Task::Default, LanguagePin* languagePin = nullptr,
+                                const JobSettings* settings = nullptr);
+    TranscriptResult transcribe(const int16_t* samples, size_t numSamples, int sampleRate = 16000,
+                                const std::string& modelPath = std::string(), JobControl* control = nullptr,
+                                Task task = Task::Default, LanguagePin* languagePin = nullptr,
+                                const JobSettings* settings = nullptr);
+    TranscriptResult transcribeFile(const std::string& audioPath, const std::string& modelPath = std::string(),
+                                    JobControl* control = nullptr, Task task = Task::Default,
+                                    LanguagePin* languagePin = nullptr, const JobSettings* settings = nullptr);
+    bool isModelLoaded() const { return modelLoaded_; }
     
     // Whisper settings - thread-safe, acquires lock
     void setLanguage(const std::string& lang) { 
@@ -34,7 +107,117 @@ public:
         std::lock_guard<std::mutex> lock(mutex_);
         speakerDiarization_ = enable;
     }
+    void setDecodingPreset(DecodingPresets::Preset preset) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        decodingPreset_ = preset;
+    }
+
+    // Built-in decoding benchmark: the reference clip is decoded with every
+    // preset on the loaded model and timed. Results are kept per model file
+    // name, indexed by preset. Like calibration, only meaningful with nothing
+    // else transcribing; Gui holds jobs back while it runs.
+    struct PresetBenchmark {
+        double realTimeFactor = 0.0; // Decode time / clip length; 0 = not measured
+        double wordErrorRate = -1.0; // Against the reference transcript
+    };
+    std::vector<PresetBenchmark> benchmarkDecodingPresets();
+    void setPresetBenchmarks(const std::map<std::string, std::vector<PresetBenchmark>>& benchmarks);
+    std::map<std::string, std::vector<PresetBenchmark>> getPresetBenchmarks() const;
+    
+    // Concurrency - number of whisper states (jobs) that can run at once on the
+    // loaded model, and CPU threads given to each job (0 = split cores evenly)
+    void setMaxConcurrentJobs(int jobs);
+    int getMaxConcurrentJobs() const;
+    void setThreadsPerJob(int threads);
+    int getEffectiveThreadsPerJob() const;
+    // Threads for speaker diarization while it runs next to whisper (0 = auto,
+    // a quarter of a job's threads). There is one diarizer and it runs one job
+    // at a time, so its threads come out of the whole budget once: each job's
+    // whisper share shrinks by this count divided over the concurrent jobs.
+    void setDiarizationThreads(int threads);
+    int getEffectiveDiarizationThreads(int jobThreads) const;
+
+    // Long-file mode: recordings over a minute are cut at silences into
+    // 30-120 s chunks that are decoded in parallel on separate states
+    // (0 workers = auto, one per four hardware threads)
+    void setLongFileChunking(bool enable);
+    // VAD pre-pass: silence is cut out before decoding and timestamps mapped back
+    void setSkipSilence(bool enable) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        skipSilence_ = enable;
+    }
+    void setChunkWorkers(int workers);
+    int getEffectiveChunkWorkers() const;
+    // Short clips are encoded with a shorter audio context than the full 30 s
+    // window (re-decoded at full context if that yields no text)
+    void setAdaptiveAudioContext(bool enable) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        adaptiveAudioContext_ = enable;
+    }
+    // Encoder output of the last few clips of up to 30 s is kept (one whisper
+    // state each), so running one again with another language or translate
+    // setting only decodes. 0 = off.
+    void setRetainedEncodings(int clips);
+
+    // Per-model thread tuning. calibrateThreads() times a short built-in clip
+    // at several thread counts on the loaded model (and a private copy of the
+    // diarizer, if ready), keeps the fastest and records it under the model's
+    // file name. Auto thread settings use the calibration of whichever model is
+    // loaded. Timings are only meaningful with no jobs running; Gui holds jobs
+    // back while it calibrates.
+    struct ThreadCalibration {
+        int whisperThreads = 0;      // 0 = not calibrated
+        int diarizationThreads = 0;
+        double whisperMs = 0.0;      // Clip time at whisperThreads
+    };
+    ThreadCalibration calibrateThreads();
+    void setThreadCalibrations(const std::map<std::string, ThreadCalibration>& calibrations);
+    std::map<std::string, ThreadCalibration> getThreadCalibrations() const;
+    bool hasThreadCalibration() const; // For the loaded model
+    std::string getModelName() const;
+
+    // The settings one job runs with, read at once so the GUI can change them
+    // while it runs. The model path is resolved (empty = the loaded model).
+    struct JobSettings {
+        std::string modelPath;
+        std::string language;
+        bool translate = false;
+        bool printTimestamps = false;
+        bool speakerDiarization = false;
+        bool longFileChunking = false;
+        int chunkWorkers = 1;    // Effective count; sets the chunk length, so it shapes the output
+        bool skipSilence = false;
+        DecodingPresets::Preset preset = DecodingPresets::Preset::Balanced;
+        bool adaptiveAudioContext = false;
+        int numSpeakers = -1;
+        std::string diarizer; // SpeakerDiarizer::describe(), empty unless diarizing
+    };
+    JobSettings snapshotSettings(const std::string& modelPath = std::string(), Task task = Task::Default) const;
+
+    // Every setting in a snapshot that changes a job's output, as one canonical
+    // string (model file and size, language, translate, diarization, ...). Equal
+    // strings mean the same audio gives the same result; used to key the
+    // result cache.
+    static std::string describeSettings(const JobSettings& settings);
     
+    // Streaming transcription (live mode): re-decodes a sliding window of the
+    // capture buffer, commits the prefix that consecutive decodes agree on and
+    // feeds committed tokens back as the prompt for the next window.
+    struct StreamConfig {
+        float windowSeconds = 10.0f;     // Audio kept uncommitted before the tail is force-committed
+        float stepSeconds = 1.0f;        // Expected interval between streamProcess calls
+        float silenceThreshold = 0.005f; // Peak amplitude below which the window isn't decoded
+        std::string modelPath;           // Model for this stream; empty uses the loaded model
+    };
+    struct StreamUpdate {
+        std::string committed; // Text that became stable in this step (append it)
+        std::string partial;   // Tentative text following everything committed so far
+        std::string error;
+    };
+    void streamBegin(const StreamConfig& config);
+    // Append new 16 kHz mono samples and re-decode the window. flush commits everything.
+    StreamUpdate streamProcess(const float* samples, size_t numSamples, bool flush = false);
+
     // Speaker diarization with sherpa-onnx
     bool initializeSpeakerDiarization(const std::string& segmentationModel,
                                        const std::string& embeddingModel,
@@ -43,15 +226,104 @@ public:
     void setNumSpeakers(int numSpeakers);
 
 private:
-    struct whisper_context* ctx_ = nullptr;
-    std::mutex mutex_;
+    static constexpr int kMinChunkSeconds = 30;
+    static constexpr int kMaxChunkSeconds = 120;
+    static constexpr float kChunkPaddingSeconds = 1.0f; // Audio shared with each neighbouring chunk
+    // Adaptive audio context: clips up to kAdaptiveCtxMaxSeconds get their length plus
+    // a margin (at least kAdaptiveCtxMinSeconds), in 64-frame steps (50 frames per second)
+    static constexpr float kAdaptiveCtxMaxSeconds = 20.0f;
+    static constexpr float kAdaptiveCtxMarginSeconds = 1.0f;
+    static constexpr float kAdaptiveCtxMinSeconds = 5.0f;
+    // Quality guard: the reduced-context result is redone at full context if speech
+    // continues this long past its last segment, or its tokens are this unsure
+    static constexpr float kAdaptiveCtxMissedSpeechSeconds = 1.0f;
+    static constexpr float kAdaptiveCtxMinTokenProbability = 0.5f;
+
+    // Encoder frames for a clip of numSamples, or 0 to use the model's full context
+    static int adaptiveAudioCtx(size_t numSamples, int sampleRate, int fullCtx);
+
+    // whisper's language detection on the first 30 s of samples; -1 on failure.
+    // The state must come from acquireFullContext(), or detection sees a partial window.
+    static int detectLanguage(WhisperModel& model, whisper_state* state, const float* samples, size_t numSamples,
+                              int nThreads, float& probability);
+
+    // Greedy decode (with whisper's timestamp rules) against the encoder output
+    // already in state; fails if the decoder doesn't finish, so callers can
+    // fall back to whisper_full
+    TranscriptResult decodeRetained(WhisperModel& model, whisper_state* state, int languageId, bool translate,
+                                    int nThreads, int64_t durationCs, JobControl* control);
+
+    // Decodes samples on the given state and collects segments and tokens
+    TranscriptResult runWhisper(WhisperModel& model, whisper_state* state, const whisper_full_params& wparams,
+                                const float* samples, size_t numSamples);
+    TranscriptResult transcribeChunked(WhisperModel& model, const float* samples, size_t numSamples, int sampleRate,
+                                       const whisper_full_params& wparams, int workers, JobControl* control);
+    void loaderLoop();
+    void warmUp();
+    void setModelState(ModelState state);
+    std::shared_ptr<WhisperModel> currentModel() const;
+    // The job's model: the loaded one, or a cached/newly loaded one by path
+    std::shared_ptr<WhisperModel> modelFor(const std::string& modelPath);
+    int threadsPerJobFor(const std::string& modelName) const;
+
+    // States needed by concurrent jobs and chunk workers
+    int getPoolCapacity() const;
+    void updatePoolCapacity();
+    // Hands the diarizer its thread count; called whenever a thread setting,
+    // calibration or the loaded model changes, never from a job
+    void updateDiarizationThreads();
+
+    // Current model; jobs take their own reference, so swapping it never waits for them
+    std::shared_ptr<WhisperModel> model_;
+    mutable std::mutex modelMutex_; // Guards model_ (held only to copy or swap the pointer)
+    std::unique_ptr<ModelCache> modelCache_; // Holds model_ too (pinned)
+    std::shared_ptr<EncoderCache> encoderCache_; // States kept for re-decoding short clips
+    std::mutex loadMutex_;          // Serializes loadModel
+    std::atomic<bool> modelLoaded_{false};
+    mutable std::mutex modelStateMutex_;
+    std::condition_variable modelStateChanged_;
+    ModelState modelState_ = ModelState::Unloaded;
+
+    std::mutex loaderMutex_;
+    std::thread loaderThread_;
+    std::string requestedModel_; // Next model for the loader thread
+    bool loaderRunning_ = false;
+
+    // Guards the settings below
+    mutable std::mutex mutex_;
     std::string language_ = "en";
     bool translate_ = false;
     bool printTimestamps_ = false;
     bool speakerDiarization_ = false;
+    DecodingPresets::Preset decodingPreset_ = DecodingPresets::Preset::Balanced;
+    int maxConcurrentJobs_ = 1;
+    int threadsPerJob_ = 0;
+    int diarizationThreads_ = 0;
+    bool longFileChunking_ = false;
+    bool skipSilence_ = false;
+    bool adaptiveAudioContext_ = true;
+    int chunkWorkers_ = 0;
+    std::string modelName_; // File name of the loaded model
+    std::map<std::string, ThreadCalibration> calibrations_;
+    std::map<std::string, std::vector<PresetBenchmark>> presetBenchmarks_;
+
+    struct StreamToken {
+        int id;
+        std::string text;
+        int64_t t0; // centiseconds from the start of the stream buffer
+        int64_t t1;
+    };
+    struct StreamState {
+        StreamConfig config;
+        std::vector<float> audio;       // Uncommitted audio, starts at the last commit point
+        std::vector<int> promptTokens;  // Tail of the committed tokens
+        std::vector<StreamToken> previous; // Uncommitted part of the previous hypothesis
+        std::weak_ptr<WhisperModel> model; // Model the prompt tokens came from
+        std::shared_ptr<LanguagePin> languagePin = std::make_shared<LanguagePin>(); // Auto-detect mode
+    };
+    StreamState stream_;
+    std::mutex streamMutex_;
 
-    bool readWav(const std::string& wavPath, std::vector<float>& pcmf32, int& sampleRate, int& channels);
-    
     // sherpa-onnx based speaker diarization (production-grade)
     std::unique_ptr<SpeakerDiarizer> diarizer_;
 };
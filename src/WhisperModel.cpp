@@ -0,0 +1,40 @@
+#include "WhisperModel.h"
+#include "Logger.h"
+#include <whisper.h>
+#include <filesystem>
+#include <iostream>
+
+std::shared_ptr<WhisperModel> WhisperModel::load(const std::string& path, int poolCapacity, UnloadHook onUnload) {
+    struct whisper_context_params cparams = whisper_context_default_params();
+    // cparams.use_gpu = true; // if available, auto-detected usually
+
+    // States come from the pool, so skip the context's built-in default state
+    whisper_context* ctx = whisper_init_from_file_with_params_no_state(path.c_str(), cparams);
+    if (!ctx) {
+        LOG_ERROR("Failed to initialize whisper context from " + path);
+        std::cerr << "Failed to initialize whisper context from " << path << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<WhisperModel> model(new WhisperModel());
+    model->ctx_ = ctx;
+    model->statePool_ = std::make_unique<WhisperStatePool>(ctx, poolCapacity);
+    model->onUnload_ = std::move(onUnload);
+    model->path_ = path;
+    model->name_ = std::filesystem::path(path).filename().string();
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    model->sizeBytes_ = ec ? 0 : static_cast<uint64_t>(size);
+    return model;
+}
+
+WhisperModel::~WhisperModel() {
+    // States must go before the context they were created from, including
+    // any held outside the pool
+    if (onUnload_) onUnload_(this);
+    statePool_.reset();
+    if (ctx_) {
+        whisper_free(ctx_);
+        LOG_INFO("Freed whisper model " + name_);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "WhisperStatePool.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+struct whisper_context;
+
+// A loaded whisper_context together with its state pool.
+// Models are shared by reference count: the engine holds the current one and
+// every job holds the model it started on, so replacing the model never waits
+// for running jobs and the old one is freed when its last job finishes.
+class WhisperModel {
+public:
+    // Runs first thing in the destructor, while the context still exists
+    using UnloadHook = std::function<void(const WhisperModel*)>;
+
+    // Returns null if the file can't be loaded
+    static std::shared_ptr<WhisperModel> load(const std::string& path, int poolCapacity,
+                                              UnloadHook onUnload = UnloadHook());
+    ~WhisperModel();
+
+    WhisperModel(const WhisperModel&) = delete;
+    WhisperModel& operator=(const WhisperModel&) = delete;
+
+    whisper_context* context() const { return ctx_; }
+    WhisperStatePool& states() { return *statePool_; }
+    const std::string& getPath() const { return path_; }
+    const std::string& getName() const { return name_; } // File name, used as the calibration key
+    // Approximate resident size (the weights; ggml keeps them as stored in the file)
+    uint64_t getSizeBytes() const { return sizeBytes_; }
+
+private:
+    WhisperModel() = default;
+
+    whisper_context* ctx_ = nullptr;
+    std::unique_ptr<WhisperStatePool> statePool_;
+    UnloadHook onUnload_;
+    std::string path_;
+    std::string name_;
+    uint64_t sizeBytes_ = 0;
+};
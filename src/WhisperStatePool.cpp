@@ -0,0 +1,198 @@
+#include "WhisperStatePool.h"
+#include "Logger.h"
+#include <whisper.h>
+#include <algorithm>
+
+void WhisperStatePool::Lease::reset() {
+    if (pool_ && state_) {
+        pool_->release(state_);
+    }
+    pool_ = nullptr;
+    state_ = nullptr;
+}
+
+whisper_state* WhisperStatePool::Lease::detach() {
+    whisper_state* state = state_;
+    if (pool_ && state_) {
+        pool_->forget();
+    }
+    pool_ = nullptr;
+    state_ = nullptr;
+    return state;
+}
+
+void WhisperStatePool::Lease::setReducedContext(bool reduced) {
+    if (!pool_ || !state_) return;
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
+    std::vector<whisper_state*>& states = pool_->reducedContext_;
+    auto it = std::find(states.begin(), states.end(), state_);
+    if (reduced && it == states.end()) {
+        states.push_back(state_);
+    } else if (!reduced && it != states.end()) {
+        states.erase(it);
+    }
+}
+
+WhisperStatePool::WhisperStatePool(whisper_context* ctx, int capacity)
+    : ctx_(ctx), capacity_(std::max(1, capacity)) {
+}
+
+WhisperStatePool::~WhisperStatePool() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (whisper_state* state : idle_) {
+        whisper_free_state(state);
+    }
+    idle_.clear();
+}
+
+void WhisperStatePool::freeState(whisper_state* state) {
+    reducedContext_.erase(std::remove(reducedContext_.begin(), reducedContext_.end(), state), reducedContext_.end());
+    whisper_free_state(state);
+}
+
+WhisperStatePool::Lease WhisperStatePool::acquireFullContext() {
+    Lease lease = acquire();
+    if (!lease) return lease;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (std::find(reducedContext_.begin(), reducedContext_.end(), lease.get()) == reducedContext_.end()) {
+            return lease;
+        }
+    }
+    // Swap it for a fresh state in the same slot
+    whisper_state* fresh = whisper_init_state(ctx_);
+    if (!fresh) {
+        LOG_ERROR("Failed to allocate whisper state for a full audio context");
+        return Lease();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    freeState(lease.state_);
+    lease.state_ = fresh;
+    return lease;
+}
+
+WhisperStatePool::Lease WhisperStatePool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [this]() {
+        return !idle_.empty() || created_ < capacity_;
+    });
+
+    if (!idle_.empty()) {
+        whisper_state* state = idle_.back();
+        idle_.pop_back();
+        inUse_++;
+        return Lease(this, state);
+    }
+
+    // Reserve the slot before allocating so other threads don't overshoot
+    created_++;
+    lock.unlock();
+
+    whisper_state* state = whisper_init_state(ctx_);
+
+    lock.lock();
+    if (!state) {
+        created_--;
+        available_.notify_one();
+        LOG_ERROR("Failed to allocate whisper state (" + std::to_string(created_) + " already allocated)");
+        return Lease();
+    }
+    inUse_++;
+    LOG_INFO("Allocated whisper state " + std::to_string(created_) + "/" + std::to_string(capacity_));
+    return Lease(this, state);
+}
+
+WhisperStatePool::Lease WhisperStatePool::tryAcquire(int keepFree) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const int available = static_cast<int>(idle_.size()) + std::max(0, capacity_ - created_);
+    if (available <= keepFree) {
+        return Lease();
+    }
+    if (!idle_.empty()) {
+        whisper_state* state = idle_.back();
+        idle_.pop_back();
+        inUse_++;
+        return Lease(this, state);
+    }
+
+    created_++;
+    lock.unlock();
+
+    whisper_state* state = whisper_init_state(ctx_);
+
+    lock.lock();
+    if (!state) {
+        created_--;
+        available_.notify_one();
+        LOG_WARNING("Failed to allocate an extra whisper state (" + std::to_string(created_) + " already allocated)");
+        return Lease();
+    }
+    inUse_++;
+    LOG_INFO("Allocated whisper state " + std::to_string(created_) + "/" + std::to_string(capacity_));
+    return Lease(this, state);
+}
+
+void WhisperStatePool::release(whisper_state* state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inUse_--;
+        if (created_ > capacity_) {
+            // Pool was shrunk while this state was busy
+            created_--;
+            freeState(state);
+        } else {
+            idle_.push_back(state);
+        }
+    }
+    available_.notify_one();
+}
+
+void WhisperStatePool::forget() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inUse_--;
+        created_--;
+    }
+    available_.notify_one();
+}
+
+void WhisperStatePool::adopt(whisper_state* state) {
+    if (!state) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (created_ < capacity_) {
+            created_++;
+            idle_.push_back(state);
+            state = nullptr;
+        }
+    }
+    if (state) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        freeState(state);
+    } else {
+        available_.notify_one();
+    }
+}
+
+void WhisperStatePool::setCapacity(int capacity) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = std::max(1, capacity);
+        while (created_ > capacity_ && !idle_.empty()) {
+            freeState(idle_.back());
+            idle_.pop_back();
+            created_--;
+        }
+    }
+    available_.notify_all();
+}
+
+int WhisperStatePool::getCapacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_;
+}
+
+int WhisperStatePool::getInUse() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inUse_;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+struct whisper_context;
+struct whisper_state;
+
+// Pool of whisper_state objects sharing one loaded whisper_context.
+// Each state owns its own KV cache and compute buffers, so several
+// whisper_full_with_state calls can run concurrently on a single model.
+// States are created lazily up to the configured capacity.
+class WhisperStatePool {
+public:
+    // RAII handle for a borrowed state; returns it to the pool on destruction
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(WhisperStatePool* pool, whisper_state* state) : pool_(pool), state_(state) {}
+        ~Lease() { reset(); }
+
+        Lease(Lease&& other) noexcept : pool_(other.pool_), state_(other.state_) {
+            other.pool_ = nullptr;
+            other.state_ = nullptr;
+        }
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                reset();
+                pool_ = other.pool_;
+                state_ = other.state_;
+                other.pool_ = nullptr;
+                other.state_ = nullptr;
+            }
+            return *this;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        whisper_state* get() const { return state_; }
+        explicit operator bool() const { return state_ != nullptr; }
+        void reset();
+        // Take the state out of the pool for good (e.g. to keep its encoder
+        // output); the pool may allocate a replacement. Hand it back with adopt().
+        whisper_state* detach();
+        // Record the audio_ctx of the last whisper_full on this state. whisper
+        // keeps it on the state for encoder runs outside whisper_full (language
+        // detection), and only whisper_full can change it.
+        void setReducedContext(bool reduced);
+
+    private:
+        friend class WhisperStatePool;
+        WhisperStatePool* pool_ = nullptr;
+        whisper_state* state_ = nullptr;
+    };
+
+    WhisperStatePool(whisper_context* ctx, int capacity);
+    ~WhisperStatePool(); // All leases must have been returned
+
+    // Blocks until a state is available. Returns an empty lease if a new
+    // state could not be allocated.
+    Lease acquire();
+    // Doesn't wait: returns an empty lease unless more than keepFree states
+    // would still be available to other callers afterwards
+    Lease tryAcquire(int keepFree = 0);
+    // Like acquire(), but the state encodes the model's full window: one left
+    // with a shortened audio context is replaced by a fresh state
+    Lease acquireFullContext();
+    // Take back a detached state, or free it if the pool is already full
+    void adopt(whisper_state* state);
+
+    // Change the maximum number of states. Shrinking frees idle states
+    // immediately and busy ones as they are returned.
+    void setCapacity(int capacity);
+    int getCapacity() const;
+    int getInUse() const;
+
+private:
+    void release(whisper_state* state);
+    void forget(); // A leased state was detached
+    void freeState(whisper_state* state); // Caller holds mutex_
+
+    whisper_context* ctx_ = nullptr;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<whisper_state*> idle_;
+    std::vector<whisper_state*> reducedContext_; // Idle, leased or detached states with a shortened audio_ctx
+    int capacity_ = 1;
+    int created_ = 0;
+    int inUse_ = 0;
+};